@@ -6,24 +6,49 @@ source ./emsdk/emsdk_env.sh
 # Create output directory
 mkdir -p web_gui/public/wasm
 
+# PTHREADS=1 ./build_wasm.sh builds a multi-threaded core (std::thread maps
+# to Web Workers over a SharedArrayBuffer memory). The page must then be
+# served cross-origin isolated (COOP/COEP headers).
+EXTRA_FLAGS=""
+if [ "$PTHREADS" = "1" ]; then
+    EXTRA_FLAGS="-pthread -s PTHREAD_POOL_SIZE=4"
+fi
+
+# STATS=1 ./build_wasm.sh compiles in the engine counters (statsReport())
+if [ "$STATS" = "1" ]; then
+    EXTRA_FLAGS="$EXTRA_FLAGS -DFS_STATS=1"
+fi
+
 # Compile C++ to WASM
 # We exclude main.cpp because we don't want the CLI entry point
 echo "Compiling C++ to WASM..."
 
 emcc -Icpp_core/include \
+    cpp_core/src/ApproximateRegex.cpp \
     cpp_core/src/Automaton.cpp \
+    cpp_core/src/CaptureNFA.cpp \
+    cpp_core/src/CountingAutomaton.cpp \
+    cpp_core/src/DotWriter.cpp \
+    cpp_core/src/Grammar.cpp \
+    cpp_core/src/IncrementalCompiler.cpp \
+    cpp_core/src/LanguageSampler.cpp \
     cpp_core/src/Matcher.cpp \
     cpp_core/src/PDA.cpp \
+    cpp_core/src/RNAFolding.cpp \
     cpp_core/src/RegexEngine.cpp \
+    cpp_core/src/Stats.cpp \
+    cpp_core/src/StreamingValidator.cpp \
+    cpp_core/src/Utf8.cpp \
     cpp_core/src/Utils.cpp \
     cpp_core/src/wasm_bindings.cpp \
     -o web_gui/public/wasm/formal_sim.js \
     -s WASM=1 \
     -s MODULARIZE=1 \
     -s EXPORT_NAME="createFormalSimModule" \
-    -s "EXPORTED_RUNTIME_METHODS=['FS']" \
+    -s "EXPORTED_RUNTIME_METHODS=['FS','HEAP8']" \
     -s ALLOW_MEMORY_GROWTH=1 \
     -s NO_DISABLE_EXCEPTION_CATCHING \
+    $EXTRA_FLAGS \
     --bind \
     -std=c++17 \
     -O3
@@ -0,0 +1,97 @@
+// Benchmark: bit-parallel CYK vs. Earley on inputs of a few thousand tokens.
+// Usage: bench_cfg [max tokens]
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../include/Grammar.h"
+
+using namespace FormalSystem;
+using namespace std;
+
+template <typename F> static double timeMillis(F &&f, bool &result) {
+  auto start = chrono::steady_clock::now();
+  result = f();
+  auto end = chrono::steady_clock::now();
+  return chrono::duration<double, milli>(end - start).count();
+}
+
+// Random Dyck word with n / 2 pairs
+static string dyck(size_t n, mt19937 &rng) {
+  string s;
+  size_t open = 0, remaining = n / 2;
+  while (remaining > 0 || open > 0) {
+    if (remaining > 0 && (open == 0 || rng() % 2)) {
+      s += '(';
+      open++;
+      remaining--;
+    } else {
+      s += ')';
+      open--;
+    }
+  }
+  return s;
+}
+
+// Random arithmetic expression of roughly n tokens
+static string expression(size_t n, mt19937 &rng) {
+  function<string(size_t)> gen = [&](size_t budget) -> string {
+    if (budget < 3)
+      return "a";
+    if (rng() % 4 == 0)
+      return "(" + gen(budget - 2) + ")";
+    size_t left = 1 + rng() % (budget - 2);
+    return gen(left) + (rng() % 2 ? "+" : "*") + gen(budget - left - 1);
+  };
+  return gen(n);
+}
+
+static string palindrome(size_t n, mt19937 &rng) {
+  string half;
+  for (size_t i = 0; i < n / 2; ++i)
+    half += "ab"[rng() % 2];
+  return half + string(half.rbegin(), half.rend());
+}
+
+static void run(const string &name, const string &rules,
+                string (*generate)(size_t, mt19937 &), size_t maxTokens) {
+  Grammar grammar = Grammar::parse(rules);
+  CYKParser cyk(grammar);
+  EarleyParser earley(grammar);
+  cout << name << " (" << grammar.productions.size() << " rules, "
+       << cyk.grammar().productions.size() << " in CNF)\n";
+
+  mt19937 rng(42);
+  for (size_t n = 500; n <= maxTokens; n *= 2) {
+    vector<int> tokens = grammar.tokenize(generate(n, rng));
+    bool r1, r2;
+    double tCyk = timeMillis([&] { return cyk.recognize(tokens); }, r1);
+    double tEarley = timeMillis([&] { return earley.recognize(tokens); }, r2);
+
+    cout << fixed << setprecision(1);
+    cout << "  n=" << setw(5) << tokens.size() << "  CYK " << setw(9) << tCyk
+         << " ms  Earley " << setw(9) << tEarley << " ms ("
+         << earley.lastItemCount() << " items)"
+         << (r1 ? "" : "  REJECT") << "\n";
+    if (r1 != r2)
+      cout << "  MISMATCH between engines!\n";
+  }
+}
+
+int main(int argc, char **argv) {
+  size_t maxTokens = argc > 1 ? atoi(argv[1]) : 4000;
+
+  run("Balanced parentheses", "S -> ( S ) S | ε", dyck, maxTokens);
+  run("Arithmetic expressions",
+      "E -> E + T | T\n"
+      "T -> T * F | F\n"
+      "F -> ( E ) | a",
+      expression, maxTokens);
+  run("Even palindromes (nondeterministic)", "S -> a S a | b S b | ε",
+      palindrome, maxTokens);
+  return 0;
+}
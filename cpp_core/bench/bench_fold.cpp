@@ -0,0 +1,53 @@
+// Benchmark: Nussinov folding, single thread vs. all cores.
+// Usage: bench_fold [max bases]
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../include/PDA.h"
+#include "../include/RNAFolding.h"
+
+using namespace FormalSystem;
+using namespace std;
+
+static double foldSeconds(const string &sequence, int threads,
+                          NussinovFolder::Result &result) {
+  NussinovFolder::Options options;
+  options.threads = threads;
+  auto start = chrono::steady_clock::now();
+  result = NussinovFolder(options).fold(sequence);
+  auto end = chrono::steady_clock::now();
+  return chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char **argv) {
+  size_t maxBases = argc > 1 ? atoi(argv[1]) : 4000;
+  int cores = max(1u, thread::hardware_concurrency());
+
+  mt19937 rng(42);
+  for (size_t n = 1000; n <= maxBases; n *= 2) {
+    string sequence;
+    for (size_t i = 0; i < n; ++i)
+      sequence += "ACGU"[rng() % 4];
+
+    NussinovFolder::Result single, parallel;
+    double t1 = foldSeconds(sequence, 1, single);
+    double tN = foldSeconds(sequence, cores, parallel);
+
+    PDA pda;
+    vector<string> log;
+    bool valid = pda.checkBalanced(single.structure, log);
+
+    cout << fixed << setprecision(3);
+    cout << "n=" << setw(5) << n << "  1 thread " << setw(7) << t1 << " s  "
+         << cores << " threads " << setw(7) << tN << " s  (" << single.pairs
+         << " pairs" << (valid ? "" : ", INVALID structure") << ")\n";
+    if (single.score != parallel.score)
+      cout << "  MISMATCH between thread counts!\n";
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+// Benchmark: JIT-compiled DFA vs. table interpreters vs. compile-time DFA.
+// Usage: bench_jit [megabytes]
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../include/DFAJit.h"
+#include "../include/RegexEngine.h"
+#include "../include/StaticRegex.h"
+
+using namespace FormalSystem;
+using namespace std;
+
+static constexpr auto kAbb = compileStaticRegex("(a|b)*abb");
+static constexpr auto kTata =
+    compileStaticRegex("(A|C|G|T)*TATA(A|T)A(A|T)(A|C|G|T)*");
+static_assert(kAbb.match("babb") && !kAbb.match("abba"));
+static_assert(kTata.match("GCTATAAAAG"));
+
+using StaticMatch = bool (*)(string_view);
+
+template <typename F> static double timeSeconds(F &&f, bool &result) {
+  auto start = chrono::steady_clock::now();
+  result = f();
+  auto end = chrono::steady_clock::now();
+  return chrono::duration<double>(end - start).count();
+}
+
+// 'skew' is the probability of repeating the first alphabet symbol, which
+// models real text where most bytes follow the same (predictable) edge
+static void run(const string &name, const string &regex, const string &alphabet,
+                size_t bytes, double skew = 0.0,
+                StaticMatch staticMatch = nullptr) {
+  DFA dfa = RegexEngine::nfaToDFA(RegexEngine::regexToNFA(regex));
+  DenseDFA dense(dfa);
+  JitDFA jit(dense);
+
+  mt19937 rng(42);
+  uniform_real_distribution<double> coin(0.0, 1.0);
+  string text(bytes, ' ');
+  for (auto &c : text)
+    c = coin(rng) < skew ? alphabet[0] : alphabet[rng() % alphabet.size()];
+
+  double mb = bytes / 1e6;
+  bool r1, r2, r3;
+  double tMap = timeSeconds([&] { return dfa.simulate(text); }, r1);
+  double tDense = timeSeconds([&] { return dense.simulate(text); }, r2);
+  double tJit = timeSeconds([&] { return jit.simulate(text); }, r3);
+  bool r4 = r3;
+  double tStatic =
+      staticMatch ? timeSeconds([&] { return staticMatch(text); }, r4) : 0;
+
+  cout << name << " (" << dense.stateCount() << " states, "
+       << (jit.isCompiled() ? "jit " + to_string(jit.codeSize()) + " bytes"
+                            : string("no jit"))
+       << ")\n";
+  cout << fixed << setprecision(1);
+  cout << "  DFA::simulate   " << setw(8) << mb / tMap << " MB/s\n";
+  cout << "  DenseDFA        " << setw(8) << mb / tDense << " MB/s\n";
+  cout << "  JitDFA          " << setw(8) << mb / tJit << " MB/s\n";
+  if (staticMatch)
+    cout << "  StaticDFA       " << setw(8) << mb / tStatic << " MB/s\n";
+  if (r1 != r2 || r2 != r3 || r3 != r4)
+    cout << "  MISMATCH between engines!\n";
+}
+
+int main(int argc, char **argv) {
+  size_t megabytes = argc > 1 ? atoi(argv[1]) : 64;
+  size_t bytes = megabytes << 20;
+
+  StaticMatch abb = [](string_view s) { return kAbb.match(s); };
+  StaticMatch tata = [](string_view s) { return kTata.match(s); };
+
+  run("(a|b)*abb, uniform text", "(a|b)*abb", "ab", bytes, 0.0, abb);
+  run("(a|b)*abb, skewed text", "(a|b)*abb", "ab", bytes, 0.98, abb);
+  run("DNA TATA box", "(A|C|G|T)*TATA(A|T)A(A|T)(A|C|G|T)*", "ACGT", bytes,
+      0.0, tata);
+  run("identifier soup",
+      "(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z|0|1|2|3)*z",
+      "abcdefghijklmnopqrstuvwxyz0123", bytes);
+  run("identifier soup, skewed text",
+      "(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z|0|1|2|3)*z",
+      "abcdefghijklmnopqrstuvwxyz0123", bytes, 0.98);
+  return 0;
+}
@@ -0,0 +1,286 @@
+// Benchmark suite over synthetic workloads, reported as JSON on stdout:
+// regex compilation (random and DFA-blowup patterns), DFA/NFA simulation and
+// approximate matching on DNA texts, deep PDA nesting, DOT generation and
+// sampling of accepted strings.
+// Every entry has latency percentiles (ms), throughput where an input size
+// applies, and the process peak RSS so far.
+// Usage: bench_suite [max text megabytes]   (default 64; 1024 for 1 GB)
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/DotWriter.h"
+#include "../include/LanguageSampler.h"
+#include "../include/Matcher.h"
+#include "../include/PDA.h"
+#include "../include/RegexEngine.h"
+#include "../include/StreamingValidator.h"
+#include "../include/Utils.h"
+
+using namespace FormalSystem;
+using namespace std;
+
+static long peakRssKB() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss; // Kilobytes on Linux
+}
+
+struct Measurement {
+  string name;     // Operation, e.g. "DFA::simulate"
+  string workload; // Input family
+  size_t size;     // Workload parameter (bytes, regex length, depth, ...)
+  size_t bytes;    // Bytes processed per run, 0 if not meaningful
+  vector<double> millis;
+  string extra; // Additional JSON fields, e.g. "\"states\": 12"
+};
+
+// Runs f at least minRuns times and until budget seconds have passed
+// (capped at maxRuns), recording each run's latency
+template <typename F>
+static vector<double> sample(F &&f, int minRuns = 5, int maxRuns = 200,
+                             double budget = 0.5) {
+  vector<double> millis;
+  double total = 0;
+  while ((int)millis.size() < minRuns ||
+         (total < budget * 1000 && (int)millis.size() < maxRuns)) {
+    auto start = chrono::steady_clock::now();
+    f();
+    auto end = chrono::steady_clock::now();
+    millis.push_back(chrono::duration<double, milli>(end - start).count());
+    total += millis.back();
+  }
+  return millis;
+}
+
+static double percentile(vector<double> values, double p) {
+  sort(values.begin(), values.end());
+  size_t rank = static_cast<size_t>(p / 100.0 * (values.size() - 1) + 0.5);
+  return values[min(rank, values.size() - 1)];
+}
+
+class Report {
+public:
+  void add(Measurement m) {
+    string &out = entries.emplace_back();
+    char buffer[512];
+    double p50 = percentile(m.millis, 50);
+    snprintf(buffer, sizeof(buffer),
+             "    {\"name\": \"%s\", \"workload\": \"%s\", \"size\": %zu, "
+             "\"runs\": %zu, \"p50Ms\": %.4f, \"p90Ms\": %.4f, "
+             "\"p99Ms\": %.4f, \"maxMs\": %.4f",
+             m.name.c_str(), m.workload.c_str(), m.size, m.millis.size(), p50,
+             percentile(m.millis, 90), percentile(m.millis, 99),
+             percentile(m.millis, 100));
+    out = buffer;
+    if (m.bytes > 0 && p50 > 0) {
+      snprintf(buffer, sizeof(buffer), ", \"throughputMBps\": %.2f",
+               m.bytes / 1e6 / (p50 / 1000));
+      out += buffer;
+    }
+    if (!m.extra.empty())
+      out += ", " + m.extra;
+    out += ", \"peakRssKB\": " + to_string(peakRssKB()) + "}";
+    cerr << m.name << " [" << m.workload << ", " << m.size
+         << "] p50 " << p50 << " ms\n";
+  }
+
+  void print(size_t maxBytes) const {
+    cout << "{\n  \"suite\": \"formal_sim\",\n  \"maxTextBytes\": " << maxBytes
+         << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < entries.size(); ++i)
+      cout << entries[i] << (i + 1 < entries.size() ? ",\n" : "\n");
+    cout << "  ],\n  \"peakRssKB\": " << peakRssKB() << "\n}\n";
+  }
+
+private:
+  vector<string> entries;
+};
+
+// Random regex over {a, b, c, d} with about `size` symbols
+static string randomRegex(size_t size, mt19937 &rng) {
+  if (size <= 1)
+    return string(1, "abcd"[rng() % 4]);
+  switch (rng() % 4) {
+  case 0: {
+    size_t left = 1 + rng() % (size - 1);
+    return "(" + randomRegex(left, rng) + "|" + randomRegex(size - left, rng) +
+           ")";
+  }
+  case 1:
+    return "(" + randomRegex(size - 1, rng) + ")*";
+  default: {
+    size_t left = 1 + rng() % (size - 1);
+    return randomRegex(left, rng) + randomRegex(size - left, rng);
+  }
+  }
+}
+
+// (a|b)*a(a|b)^(n-1): the subset construction needs 2^n states
+static string blowupRegex(int n) {
+  string regex = "(a|b)*a";
+  for (int i = 1; i < n; ++i)
+    regex += "(a|b)";
+  return regex;
+}
+
+static string dnaText(size_t bytes, mt19937 &rng) {
+  string text(bytes, 'A');
+  for (auto &c : text)
+    c = "ACGT"[rng() & 3];
+  return text;
+}
+
+static void benchRegex(Report &report) {
+  mt19937 rng(1);
+  for (size_t size : {8, 16, 32, 64, 128, 256}) {
+    vector<string> regexes;
+    for (int i = 0; i < 50; ++i)
+      regexes.push_back(randomRegex(size, rng));
+
+    vector<double> nfaMillis, dfaMillis;
+    size_t states = 0;
+    for (const auto &regex : regexes) {
+      nfaMillis.push_back(sample([&] { RegexEngine::regexToNFA(regex); }, 1, 1)
+                              .front());
+      NFA nfa = RegexEngine::regexToNFA(regex);
+      DFA dfa;
+      dfaMillis.push_back(
+          sample([&] { dfa = RegexEngine::nfaToDFA(nfa); }, 1, 1).front());
+      states = max(states, dfa.states.size());
+    }
+    report.add({"RegexEngine::regexToNFA", "random regex", size, 0, nfaMillis,
+                ""});
+    report.add({"RegexEngine::nfaToDFA", "random regex", size, 0, dfaMillis,
+                "\"maxDfaStates\": " + to_string(states)});
+  }
+
+  for (int n : {4, 8, 10, 12, 14}) {
+    string regex = blowupRegex(n);
+    NFA nfa = RegexEngine::regexToNFA(regex);
+    DFA dfa;
+    auto millis =
+        sample([&] { dfa = RegexEngine::nfaToDFA(nfa); }, 3, 20, 1.0);
+    report.add({"RegexEngine::nfaToDFA", "blowup (a|b)*a(a|b)^(n-1)", (size_t)n,
+                0, millis, "\"dfaStates\": " + to_string(dfa.states.size())});
+  }
+}
+
+static void benchText(Report &report, size_t maxBytes) {
+  mt19937 rng(2);
+  string regex = "(A|C|G|T)*TATA(A|T)A(A|T)(A|C|G|T)*";
+  NFA nfa = RegexEngine::regexToNFA(regex);
+  DFA dfa = RegexEngine::nfaToDFA(nfa);
+  const size_t nfaLimit = 256 << 10; // Set-based NFA simulation is slow
+
+  for (size_t bytes = 1 << 10; bytes <= maxBytes; bytes <<= 4) {
+    string text = dnaText(bytes, rng);
+    int runs = bytes >= (64u << 20) ? 1 : 5;
+    volatile bool sink = false;
+
+    report.add({"DFA::simulate", "DNA, TATA box regex", bytes, bytes,
+                sample([&] { sink = dfa.simulate(text); }, runs), ""});
+    if (bytes <= nfaLimit)
+      report.add({"NFA::simulate", "DNA, TATA box regex", bytes, bytes,
+                  sample([&] { sink = nfa.simulate(text); }, runs), ""});
+    // Two N's can never match DNA, so with k=1 the whole text is scanned
+    report.add({"Matcher::approximateMatch", "DNA, 12-mer with 2 N, k=1",
+                bytes, bytes, sample([&] {
+                  sink = Matcher::approximateMatch(text, "GATNACAGNTTA", 1);
+                }, runs), ""});
+    (void)sink;
+    if (bytes == maxBytes)
+      break;
+    if (bytes << 4 > maxBytes)
+      bytes = maxBytes >> 4; // Always end on the largest size
+  }
+}
+
+static void benchPDA(Report &report) {
+  for (size_t depth = 1 << 10; depth <= (16u << 20); depth <<= 4) {
+    string anbn = string(depth, 'a') + string(depth, 'b');
+    volatile bool sink = false;
+    PDA pda;
+    report.add({"PDA::simulate", "a^n b^n", depth, anbn.size(),
+                sample([&] { sink = pda.simulate(anbn); }), ""});
+
+    string nested = string(depth, '[') + string(depth, ']');
+    report.add({"StreamingTagValidator::feed", "JSON nesting depth n", depth,
+                nested.size(), sample([&] {
+                  StreamingTagValidator validator(StreamingTagValidator::JSON);
+                  validator.feed(nested);
+                  sink = validator.finish().valid;
+                }),
+                ""});
+    (void)sink;
+  }
+}
+
+static void benchDOT(Report &report) {
+  for (int n : {6, 10, 14}) {
+    DFA dfa = RegexEngine::nfaToDFA(RegexEngine::regexToNFA(blowupRegex(n)));
+    size_t bytes = Utils::generateDOT(dfa).size();
+    auto millis = sample([&] { Utils::generateDOT(dfa); });
+    report.add({"Utils::generateDOT", "blowup DFA", dfa.states.size(), bytes,
+                millis, ""});
+
+    DotOptions options;
+    options.maxStates = 300;
+    size_t bounded = 0;
+    millis = sample([&] {
+      bounded = 0;
+      DotSink sink([&](const char *, size_t length) { bounded += length; });
+      DotWriter::write(dfa, sink, options);
+    });
+    report.add({"DotWriter::write", "blowup DFA, 300-state budget",
+                dfa.states.size(), 0, millis,
+                "\"dotBytes\": " + to_string(bounded)});
+  }
+}
+
+static void benchSampler(Report &report) {
+  for (const char *regex :
+       {"(A|C|G|T)*TATA(A|T)A(A|T)(A|C|G|T)*", "(a|b)*a(a|b)(a|b)(a|b)"}) {
+    DFA dfa = RegexEngine::nfaToDFA(RegexEngine::regexToNFA(regex));
+    LanguageSampler sampler(dfa, 64);
+    sampler.seed(3);
+    const size_t count = 100000;
+    for (double nearMissRate : {0.0, 0.5}) {
+      string bytes;
+      vector<int32_t> ends;
+      auto millis = sample([&] {
+        bytes.clear();
+        ends.clear();
+        sampler.generate(count, 8, 64, nearMissRate, bytes, ends);
+      });
+      double p50 = percentile(millis, 50);
+      report.add({"LanguageSampler::generate",
+                  string(regex) + ", lengths 8-64, near-miss rate " +
+                      (nearMissRate > 0 ? "0.5" : "0"),
+                  count, bytes.size(), millis,
+                  "\"stringsPerSecond\": " +
+                      to_string(static_cast<long>(count / (p50 / 1000)))});
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  size_t megabytes = argc > 1 ? atoi(argv[1]) : 64;
+  size_t maxBytes = max<size_t>(megabytes, 1) << 20;
+
+  Report report;
+  benchRegex(report);
+  benchText(report, maxBytes);
+  benchPDA(report);
+  benchDOT(report);
+  benchSampler(report);
+  report.print(maxBytes);
+  return 0;
+}
@@ -0,0 +1,77 @@
+#ifndef APPROXIMATE_REGEX_H
+#define APPROXIMATE_REGEX_H
+
+#include "Automaton.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Finds substrings within k edits (Levenshtein) of some word of a
+ * regex, by Wu-Manber bit-parallel simulation of its Thompson NFA.
+ *
+ * States are renumbered so every symbol edge goes from bit s to bit s+1;
+ * a step is then a shift, and epsilon closures are looked up per 8-bit
+ * chunk of the state set. One state set is kept per error count, so a scan
+ * costs O(n * k * (m / 64)) word operations for n bytes and m states.
+ */
+class ApproximateRegex {
+public:
+  ApproximateRegex(const NFA &nfa, int maxErrors);
+  ApproximateRegex(const std::string &regex, int maxErrors);
+
+  int maxErrors() const { return errors; }
+  int stateCount() const { return states; }
+
+  /**
+   * @brief True if some substring of the text is within maxErrors of the
+   * regex's language.
+   */
+  bool search(const std::string &text) const;
+  bool search(const char *text, size_t length) const;
+
+  /**
+   * @brief Collects every end offset i (0..length) such that some substring
+   * text[s..i) is within maxErrors of the language. Returns the count.
+   */
+  size_t matchEnds(const char *text, size_t length,
+                   std::vector<int32_t> &ends) const;
+
+private:
+  using Word = uint64_t;
+  static const int CHUNK_BITS = 8;
+
+  // Symbol edges that do not fit the s -> s+1 layout
+  struct Edge {
+    int from;
+    int to;
+    unsigned char symbol;
+  };
+
+  int errors;
+  int states = 0;
+  int words = 0;
+  bool chunked = false;       // Closure by 8-bit chunks, else per state
+  std::vector<Word> symbolMask; // [byte * words]: sources of byte edges
+  std::vector<Word> anyMask;  // Sources of any symbol edge
+  std::vector<Word> finalMask;
+  std::vector<Word> closures; // [chunk][value] or [state] -> closure set
+  std::vector<Word> initial;  // [errors + 1][words]: start, then deletions
+  std::vector<Edge> extraEdges;
+
+  void build(const NFA &nfa);
+  template <int W> void close(const Word *in, Word *out) const;
+  template <int W> void move(const Word *in, int symbol, Word *out) const;
+  template <int W, typename OnEnd>
+  void scan(const char *text, size_t length, OnEnd onEnd) const;
+  template <typename OnEnd>
+  void scan(const char *text, size_t length, OnEnd onEnd) const;
+};
+
+} // namespace FormalSystem
+
+#endif // APPROXIMATE_REGEX_H
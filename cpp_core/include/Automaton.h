@@ -79,6 +79,10 @@ public:
   bool simulate(const std::string &input) override;
   std::vector<int> getTrace(const std::string &input);
   void printTransitions() const override;
+
+  // Raw byte views (e.g. WASM linear memory), no std::string copy
+  bool simulate(const char *data, size_t length) const;
+  void getTrace(const char *data, size_t length, std::vector<int> &trace) const;
 };
 
 } // namespace FormalSystem
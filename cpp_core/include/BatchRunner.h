@@ -0,0 +1,80 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include "ApproximateRegex.h"
+#include "DenseDFA.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Non-interactive line filter behind `formal_sim --batch`.
+ *
+ * Rules are compiled once, one per line of a rules file ('#' comments and
+ * blank lines are skipped):
+ *   regex <pattern>       the whole line is in the language (DenseDFA)
+ *   approx <pattern> <k>  some substring is within k errors (literal
+ *                         Levenshtein, or ApproximateRegex for regexes)
+ * Input is read in large blocks cut at line ends; blocks are matched on
+ * worker threads and their output is written in input order through one
+ * buffered writer. Each input line gives a line of '0'/'1' verdicts, one
+ * per rule, or in filter mode the input line itself if any rule matched.
+ */
+class BatchRunner {
+public:
+  struct Options {
+    unsigned threads = 0;         // 0: hardware concurrency
+    size_t blockSize = 1 << 20;   // Bytes read per block (whole lines)
+    bool filter = false;          // Print matching lines, not verdicts
+  };
+
+  BatchRunner() = default;
+
+  /**
+   * @brief Compiles one rule line. Throws std::runtime_error on syntax
+   * errors; comments and blank lines are ignored.
+   */
+  void addRule(const std::string &line);
+
+  /**
+   * @brief Reads a rules file; errors are prefixed with "path:line: ".
+   */
+  void loadRules(const std::string &path);
+
+  size_t ruleCount() const { return rules.size(); }
+
+  /**
+   * @brief Whether rule i accepts the line (without its newline).
+   */
+  bool matches(size_t rule, const char *line, size_t length) const;
+
+  /**
+   * @brief Runs the pipeline from in to out. Returns the number of lines.
+   */
+  uint64_t run(std::FILE *in, std::FILE *out, const Options &options) const;
+
+private:
+  enum Kind { Whole, Literal, Regex };
+
+  struct Rule {
+    Kind kind;
+    std::string pattern;
+    int maxErrors = 0;
+    std::unique_ptr<DenseDFA> dfa;
+    std::unique_ptr<ApproximateRegex> approx;
+  };
+
+  void processBlock(const std::string &input, std::string &output,
+                    bool filter) const;
+
+  std::vector<Rule> rules;
+};
+
+} // namespace FormalSystem
+
+#endif // BATCH_RUNNER_H
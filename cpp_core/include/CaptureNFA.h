@@ -0,0 +1,81 @@
+#ifndef CAPTURE_NFA_H
+#define CAPTURE_NFA_H
+
+#include "Automaton.h"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Thompson program with capture slots for submatch extraction.
+ *
+ * Matching is anchored at both ends (like DFA::simulate) with leftmost-first
+ * priority: the left side of '|' and another iteration of '*' are preferred.
+ * Patterns where at most one thread can survive each input symbol also get a
+ * one-pass DFA, which reports captures without keeping any threads. All
+ * other patterns fall back to a Pike VM. Both run in O(n * m) or better.
+ */
+class CaptureNFA : public Automaton {
+public:
+  struct Node {
+    enum Kind { Char, Split, Save, Match };
+
+    Kind kind;
+    char symbol = 0; // Char
+    int out = -1;    // Next node (preferred branch for Split)
+    int out1 = -1;   // Split: second branch
+    int slot = -1;   // Save: capture slot (2 * group, 2 * group + 1)
+  };
+
+  /**
+   * @brief Patterns with more one-pass states than this use the Pike VM.
+   */
+  static const int MAX_ONEPASS_STATES = 4096;
+
+  std::vector<Node> nodes;
+  int start;
+  int groupCount; // Number of groups, including group 0 (whole match)
+  std::set<char> alphabet;
+
+  CaptureNFA();
+
+  /**
+   * @brief Builds the one-pass table if the program is one-pass.
+   * Called by RegexEngine::regexToCaptureNFA.
+   */
+  void buildOnePass();
+  bool isOnePass() const { return onePass; }
+
+  /**
+   * @brief Full match with submatch extraction. On success captures holds
+   * 2 * groupCount offsets (start, end) per group, -1 if the group did not
+   * participate.
+   */
+  bool match(const std::string &input, std::vector<int> &captures) const;
+  bool pikeMatch(const std::string &input, std::vector<int> &captures) const;
+  bool onePassMatch(const std::string &input,
+                    std::vector<int> &captures) const;
+
+  bool simulate(const std::string &input) override;
+  void printTransitions() const override;
+
+private:
+  struct OnePassEntry {
+    int next = -1;   // Next one-pass state, -1 if the symbol is rejected
+    int actions = 0; // Index into onePassActions (Save slots to set)
+  };
+
+  bool onePass;
+  std::vector<int> onePassStateOf; // Node ID -> one-pass state, or -1
+  std::vector<std::array<OnePassEntry, 256>> onePassTable;
+  std::vector<int> onePassMatchActions; // Per state, -1 if not accepting
+  std::vector<std::vector<int>> onePassActions;
+
+  bool walkOnePass(int state, int from);
+};
+
+} // namespace FormalSystem
+
+#endif // CAPTURE_NFA_H
@@ -0,0 +1,57 @@
+#ifndef COUNTING_AUTOMATON_H
+#define COUNTING_AUTOMATON_H
+
+#include "Automaton.h"
+#include <string>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief NFA with counters for bounded repetitions (counting-set automaton).
+ *
+ * A repetition r{m,n} compiles its body once, wrapped in an Enter node that
+ * starts a counter at 1 and a Loop node that either increments it (if < n)
+ * and jumps back, or leaves the body (if >= m). During simulation every node
+ * inside a counter's scope holds the set of live counter values, so the
+ * number of nodes is independent of m and n. Nested bounded repetitions are
+ * not supported in this mode.
+ */
+class CountingNFA : public Automaton {
+public:
+  struct Node {
+    enum Kind { Char, Split, Enter, Loop, Match };
+
+    Kind kind;
+    char symbol = 0; // Char
+    int out = -1;    // Char/Split/Enter: next; Loop: back to body start
+    int out1 = -1;   // Split: second branch; Loop: exit
+    int counter = -1; // Enter/Loop: counter ID
+    int scope = -1;   // Counter whose body contains this node, -1 if none
+  };
+
+  struct Counter {
+    int min;
+    int max; // -1 when unbounded
+  };
+
+  std::vector<Node> nodes;
+  std::vector<Counter> counters;
+  int start;
+  std::set<char> alphabet;
+
+  CountingNFA();
+  bool simulate(const std::string &input) override;
+  void printTransitions() const override;
+
+private:
+  using CountingSet = std::vector<int>; // Sorted live counter values
+
+  bool addToSet(std::vector<CountingSet> &sets, std::vector<int> &active,
+                int node, const CountingSet &values);
+  void closure(std::vector<CountingSet> &sets, std::vector<int> &active);
+};
+
+} // namespace FormalSystem
+
+#endif // COUNTING_AUTOMATON_H
@@ -0,0 +1,59 @@
+#ifndef DFA_ALGEBRA_H
+#define DFA_ALGEBRA_H
+
+#include "DenseDFA.h"
+#include <array>
+#include <cstddef>
+#include <string>
+
+namespace FormalSystem {
+
+/**
+ * @brief Boolean operations and equivalence on DenseDFA tables.
+ *
+ * Everything works over byte classes: the alphabet of a binary operation is
+ * the common refinement of both class partitions, so the cost per state is
+ * the number of distinct classes rather than 256. Products only materialize
+ * pairs reachable from the start pair.
+ */
+class DFAAlgebra {
+public:
+  enum Operation { Intersection, Union, Difference, SymmetricDifference };
+
+  /**
+   * @brief Product automaton for L(a) op L(b). Pairs that can no longer
+   * accept under op are pruned to DEAD. Throws if more than maxStates
+   * (0 = no limit) states would be created.
+   */
+  static DenseDFA product(const DenseDFA &a, const DenseDFA &b, Operation op,
+                          size_t maxStates = 0);
+
+  /**
+   * @brief Accepts alphabet* minus L(a). Strings containing bytes outside
+   * the alphabet are rejected.
+   */
+  static DenseDFA complement(const DenseDFA &a, const std::string &alphabet);
+
+  /**
+   * @brief Hopcroft-Karp union-find equivalence check. On a mismatch, the
+   * counterexample (accepted by exactly one side) is stored if requested.
+   */
+  static bool equivalent(const DenseDFA &a, const DenseDFA &b,
+                         std::string *counterexample = nullptr);
+
+  /**
+   * @brief Shortest accepted string (BFS). False if L(a) is empty.
+   */
+  static bool shortestAccepted(const DenseDFA &a, std::string &witness);
+
+  /**
+   * @brief Coarsest byte classes refining those of both automata.
+   * Returns the class count.
+   */
+  static int refineClasses(const DenseDFA &a, const DenseDFA &b,
+                           std::array<uint8_t, 256> &classes);
+};
+
+} // namespace FormalSystem
+
+#endif // DFA_ALGEBRA_H
@@ -0,0 +1,65 @@
+#ifndef DFA_JIT_H
+#define DFA_JIT_H
+
+#include "DenseDFA.h"
+#include <cstddef>
+#include <string>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define FS_JIT_SUPPORTED 1
+#else
+#define FS_JIT_SUPPORTED 0
+#endif
+
+namespace FormalSystem {
+
+/**
+ * @brief Compiles a DFA to x86-64 machine code (one basic block per state).
+ *
+ * Each state tests for end of input, loads the next byte and dispatches with
+ * a compare chain over byte ranges, or with a 256-entry jump table when a
+ * state has many ranges. The code lives in its own mmap'd page, which is made
+ * read+execute only after it has been written. On other platforms, or if
+ * code generation fails, simulate() falls back to the DenseDFA interpreter.
+ */
+class JitDFA {
+public:
+  /**
+   * @brief States with more byte ranges than this use a jump table.
+   */
+  static const int MAX_COMPARE_RANGES = 8;
+  /**
+   * @brief Generated code larger than this is not emitted.
+   */
+  static const size_t MAX_CODE_SIZE = 64 << 20;
+
+  explicit JitDFA(const DFA &dfa);
+  explicit JitDFA(const DenseDFA &dense);
+  ~JitDFA();
+
+  JitDFA(const JitDFA &) = delete;
+  JitDFA &operator=(const JitDFA &) = delete;
+
+  /**
+   * @brief True if native code was generated.
+   */
+  bool isCompiled() const { return code != nullptr; }
+  size_t codeSize() const { return size; }
+
+  bool simulate(const std::string &input) const;
+  bool simulate(const char *data, size_t length) const;
+
+private:
+  using MatchFn = int (*)(const unsigned char *, const unsigned char *);
+
+  DenseDFA fallback;
+  void *code;
+  size_t size;
+  MatchFn entry;
+
+  void compile();
+};
+
+} // namespace FormalSystem
+
+#endif // DFA_JIT_H
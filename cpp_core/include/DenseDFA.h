@@ -0,0 +1,77 @@
+#ifndef DENSE_DFA_H
+#define DENSE_DFA_H
+
+#include "Automaton.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Flat transition table built from a DFA.
+ *
+ * Bytes that behave identically in every state share a byte class, so a
+ * row holds classCount entries (padded to a power of two so the scan loop
+ * indexes with a shift) instead of 256. States are renumbered
+ * 0..n-1 with the start state at 0. Missing transitions go to DEAD. This is
+ * the table interpreter used as the fast path for matching, the fallback
+ * when no JIT is available, and the form DFAAlgebra works on.
+ */
+class DenseDFA {
+public:
+  static constexpr int32_t DEAD = -1;
+
+  std::vector<int32_t> table; // table[(state << shift) + byteClass[byte]]
+  std::array<uint8_t, 256> byteClass;
+  int classCount;
+  int shift; // log2 of the row width
+  std::vector<uint8_t> accepting;
+  std::vector<int> originalIds; // Dense ID -> DFA::DFAState::id (if any)
+  int32_t start;
+
+  DenseDFA();
+  explicit DenseDFA(const DFA &dfa);
+
+  int stateCount() const { return accepting.size(); }
+  int32_t next(int32_t state, unsigned char c) const {
+    return table[(static_cast<size_t>(state) << shift) + byteClass[c]];
+  }
+  int32_t &at(int32_t state, int cls) {
+    return table[(static_cast<size_t>(state) << shift) + cls];
+  }
+
+  /**
+   * @brief Resets to an empty automaton over the given byte classes.
+   */
+  void setClasses(const std::array<uint8_t, 256> &classes, int count);
+
+  /**
+   * @brief Appends a state with every transition going to DEAD.
+   */
+  int32_t addState(bool isAccepting);
+
+  /**
+   * @brief Smallest byte of each class (classCount entries).
+   */
+  std::vector<unsigned char> classRepresentatives() const;
+
+  /**
+   * @brief Merges byte classes whose columns are identical in all states.
+   * Builders may start from finer classes (e.g. one per byte) and call this.
+   */
+  void compressClasses();
+
+  /**
+   * @brief Back to the map-based form (for DOT export and the CLI).
+   */
+  DFA toDFA() const;
+
+  bool simulate(const std::string &input) const;
+  bool simulate(const char *data, size_t length) const;
+};
+
+} // namespace FormalSystem
+
+#endif // DENSE_DFA_H
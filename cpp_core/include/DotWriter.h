@@ -0,0 +1,95 @@
+#ifndef DOT_WRITER_H
+#define DOT_WRITER_H
+
+#include "Automaton.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Fixed-size output buffer that hands full chunks to a callback
+ * (file, string, JS), so DOT text never has to exist in memory as a whole.
+ */
+class DotSink {
+public:
+  using Flush = std::function<void(const char *, size_t)>;
+
+  explicit DotSink(Flush flush, size_t capacity = 1 << 16);
+  ~DotSink();
+  DotSink(const DotSink &) = delete;
+  DotSink &operator=(const DotSink &) = delete;
+
+  void write(const char *data, size_t length);
+  void flush();
+
+  DotSink &operator<<(const std::string &text) {
+    write(text.data(), text.size());
+    return *this;
+  }
+  DotSink &operator<<(const char *text);
+  DotSink &operator<<(char c) {
+    write(&c, 1);
+    return *this;
+  }
+  DotSink &operator<<(long long value);
+  DotSink &operator<<(int value) {
+    return *this << static_cast<long long>(value);
+  }
+  DotSink &operator<<(size_t value) {
+    return *this << static_cast<long long>(value);
+  }
+
+private:
+  std::vector<char> buffer;
+  size_t used = 0;
+  Flush out;
+};
+
+struct DotOptions {
+  size_t maxStates = 0;     // 0 = no budget; otherwise BFS order from start
+  int maxDepth = -1;        // -1 = no limit; BFS depth from the start state
+  bool mergeEdges = true;   // One edge per (from, to) with a label like a-z
+  bool clusterSCCs = false; // Draw each non-trivial SCC as a cluster
+  std::string nodePrefix;   // Prepended to state IDs, e.g. "q"
+};
+
+struct DotStats {
+  size_t states = 0;
+  size_t edges = 0;
+  size_t omittedStates = 0; // Collapsed into a single "more" node
+  size_t clusters = 0;
+};
+
+/**
+ * @brief Streams automata to DOT through a DotSink.
+ *
+ * Without limits and with mergeEdges off, the output is identical to the
+ * classic one-edge-per-symbol format of Utils::generateDOT. States beyond
+ * the budget or depth limit are replaced by one box node that all cut
+ * edges point to.
+ */
+class DotWriter {
+public:
+  static DotStats write(const DFA &dfa, DotSink &sink,
+                        const DotOptions &options);
+  static DotStats write(const NFA &nfa, DotSink &sink,
+                        const DotOptions &options);
+
+  /**
+   * @brief Compact label for a symbol set: runs of 3+ consecutive bytes
+   * become ranges ("a-z,0-9,_"). DOT-escaped.
+   */
+  static std::string rangeLabel(std::vector<char> symbols);
+
+private:
+  struct Graph;
+  static DotStats writeGraph(const Graph &graph, const char *name,
+                             DotSink &sink, const DotOptions &options);
+};
+
+} // namespace FormalSystem
+
+#endif // DOT_WRITER_H
@@ -0,0 +1,125 @@
+#ifndef GRAMMAR_H
+#define GRAMMAR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Context-free grammar with a text loader and CNF conversion.
+ *
+ * Text format, one rule per line ('#' starts a comment):
+ *   S -> a S b | ε
+ * The first left-hand side is the start symbol, every left-hand side is a
+ * nonterminal and any other symbol is a terminal. Symbols are separated by
+ * whitespace; 'x' or "x" quotes a terminal, and ε, eps or an empty
+ * alternative stands for the empty string. When every nonterminal name is a
+ * single character, unspaced textbook rules like S -> aSb also work.
+ *
+ * Symbols are ints: nonterminal n is n, terminal t is ~t (negative).
+ */
+class Grammar {
+public:
+  struct Production {
+    int lhs;
+    std::vector<int> rhs; // Empty = epsilon
+  };
+
+  std::vector<std::string> nonterminals;
+  std::vector<std::string> terminals;
+  std::vector<Production> productions;
+  int start = 0;
+
+  static bool isTerminal(int symbol) { return symbol < 0; }
+  static int terminalSymbol(int terminal) { return ~terminal; }
+
+  /**
+   * @brief Parses the text format above. Throws std::runtime_error with the
+   * offending line number on malformed input.
+   */
+  static Grammar parse(const std::string &text);
+
+  int addNonterminal(const std::string &name);
+  int addTerminal(const std::string &name);
+  int findTerminal(const std::string &name) const;
+
+  /**
+   * @brief Splits input into terminal IDs: one per non-space character when
+   * every terminal is a single character, else one per whitespace-separated
+   * word. Unknown tokens map to -1, which no rule matches.
+   */
+  std::vector<int> tokenize(const std::string &text) const;
+
+  std::vector<bool> nullable() const;
+  bool isCNF() const;
+
+  /**
+   * @brief Equivalent grammar in Chomsky normal form (START, TERM, BIN, DEL,
+   * UNIT). Only the new start symbol may have an epsilon rule.
+   */
+  Grammar toCNF() const;
+
+  std::string toString() const;
+};
+
+/**
+ * @brief CYK recognizer over the CNF form of a grammar, bit-parallel over
+ * split points.
+ *
+ * The chart stores, for each start position i and nonterminal B, a bitset
+ * of end positions e such that B derives tokens[i, e), and the transposed
+ * bitset of start positions per end. Rule A -> B C spans [i, j) iff
+ * ends(i, B) AND starts(j, C) is non-zero, so all split points of a span
+ * are tested 64 at a time with word-level ANDs.
+ */
+class CYKParser {
+public:
+  explicit CYKParser(const Grammar &grammar);
+
+  bool recognize(const std::vector<int> &tokens) const;
+  bool recognize(const std::string &text) const {
+    return recognize(cnf.tokenize(text));
+  }
+  const Grammar &grammar() const { return cnf; }
+
+private:
+  struct BinaryRule {
+    int lhs, left, right;
+  };
+
+  Grammar cnf;
+  bool acceptsEmpty = false;
+  std::vector<std::vector<int>> byTerminal; // Terminal -> A with A -> t
+  std::vector<BinaryRule> binary;
+};
+
+/**
+ * @brief Earley recognizer for arbitrary CFGs (no CNF needed), with the
+ * Aycock-Horspool fix for nullable nonterminals.
+ */
+class EarleyParser {
+public:
+  explicit EarleyParser(const Grammar &grammar);
+
+  bool recognize(const std::vector<int> &tokens) const;
+  bool recognize(const std::string &text) const {
+    return recognize(g.tokenize(text));
+  }
+
+  /**
+   * @brief Items created by the last recognize() call.
+   */
+  size_t lastItemCount() const { return items; }
+
+private:
+  Grammar g;
+  std::vector<bool> isNullable;
+  std::vector<std::vector<int>> byLhs; // Nonterminal -> production indices
+  mutable size_t items = 0;
+};
+
+} // namespace FormalSystem
+
+#endif // GRAMMAR_H
@@ -0,0 +1,106 @@
+#ifndef INCREMENTAL_COMPILER_H
+#define INCREMENTAL_COMPILER_H
+
+#include "Automaton.h"
+#include "Utf8.h"
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Thrown by IncrementalCompiler::compile for a valid pattern whose DFA
+ * exceeds MAX_DFA_STATES (syntax errors stay plain std::runtime_error).
+ */
+class DFATooLargeError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Regex -> DFA compiler that keeps its work between calls.
+ *
+ * Sub-expressions are hash-consed (one node per distinct postfix subtree),
+ * and the NFA is the partial-derivative (Antimirov) automaton over those
+ * nodes, so a node's outgoing transitions are computed once and shared by
+ * every pattern that contains the same subtree. Determinization memoizes
+ * each (state set, symbol) transition as well; after an edit, only state
+ * sets that did not occur in earlier patterns are expanded. Meant for
+ * interactive editing, where consecutive patterns share most subtrees.
+ */
+class IncrementalCompiler {
+public:
+  struct Stats {
+    int expressions = 0;         // Hash-consed nodes kept across calls
+    int stateSets = 0;           // Memoized DFA state sets
+    int computedTransitions = 0; // Last compile: transitions built
+    int reusedTransitions = 0;   // Last compile: transitions from the memo
+    bool tooLarge = false; // Last compile threw DFATooLargeError
+  };
+
+  /**
+   * @brief Memo tables are dropped when they grow past this many nodes.
+   */
+  static const int MAX_EXPRESSIONS = 200000;
+  /**
+   * @brief Memo tables are also dropped past this many state sets, since
+   * every distinct pattern may add up to MAX_DFA_STATES of them.
+   */
+  static const int MAX_STATE_SETS = 100000;
+  /**
+   * @brief Largest DFA produced before compile() throws DFATooLargeError.
+   */
+  static const int MAX_DFA_STATES = 10000;
+
+  IncrementalCompiler();
+
+  /**
+   * @brief Compiles the regex (same syntax as RegexEngine) to a DFA with
+   * states numbered 0..n-1 in BFS order from the start state.
+   */
+  DFA compile(const std::string &regex);
+  void clear();
+  Stats lastStats() const { return stats; }
+
+private:
+  struct Expr {
+    enum Kind { Epsilon, Symbol, Concat, Union, Star, Repeat };
+
+    Kind kind;
+    int left = -1;
+    int right = -1;
+    char symbol = 0;
+    int min = 0;
+    int max = 0;
+    bool nullable = false;
+  };
+
+  using ExprKey = std::tuple<int, int, int, char, int, int>;
+  using ExprSet = std::vector<int>; // Sorted node IDs
+
+  std::vector<Expr> exprs;
+  std::map<ExprKey, int> interned;
+  std::unordered_map<long long, ExprSet> derivatives; // (node, symbol) key
+
+  std::map<ExprSet, int> setIds;
+  std::vector<ExprSet> sets;
+  std::vector<std::map<char, int>> setTransitions; // -1 = no transition
+  Stats stats;
+
+  int make(Expr e);
+  int epsilon();
+  int concat(int left, int right);
+  int repeat(int inner, int min, int max);
+  int byteClass(const Utf8Automaton &bytes, std::set<char> &alphabet);
+  const ExprSet &derivative(int expr, char symbol);
+  int setId(const ExprSet &set);
+  int step(int set, char symbol);
+};
+
+} // namespace FormalSystem
+
+#endif // INCREMENTAL_COMPILER_H
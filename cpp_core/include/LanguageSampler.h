@@ -0,0 +1,99 @@
+#ifndef LANGUAGE_SAMPLER_H
+#define LANGUAGE_SAMPLER_H
+
+#include "Automaton.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Counts the strings a DFA accepts and draws them uniformly.
+ *
+ * W[k][s], the number of accepted strings of length k starting in state s,
+ * is tabulated as log2 W[k][s] for k <= maxLength by a DP over the
+ * transition table, so counts far beyond 2^1024 (and states whose counts
+ * differ by more than that) stay usable for sampling. Exact counts use big
+ * integers, and counts for lengths past the table use matrix powers, also
+ * in log2.
+ */
+class LanguageSampler {
+public:
+  /**
+   * @brief Largest DFA for which log2Count() beyond maxLength is supported
+   * (the matrix power is cubic in the state count).
+   */
+  static const int MAX_MATRIX_STATES = 256;
+
+  LanguageSampler(const DFA &dfa, int maxLength);
+
+  int maxLength() const { return tableLength; }
+  int stateCount() const { return accepting.size(); }
+
+  /**
+   * @brief log2 of the number of accepted strings of the given length;
+   * -infinity if there are none.
+   */
+  double log2Count(uint64_t length) const;
+
+  /**
+   * @brief Exact number of accepted strings of the given length, in decimal.
+   */
+  std::string countExact(int length) const;
+
+  void seed(uint64_t value) { rng.seed(value); }
+
+  /**
+   * @brief Draws an accepted string uniformly from all accepted strings with
+   * length in [minLength, maxLength] (both <= maxLength()). False if there
+   * are none.
+   */
+  bool sample(int minLength, int maxLength, std::string &out);
+
+  /**
+   * @brief A rejected string one random edit (substitution, insertion or
+   * deletion) away from a uniform sample. False if the range has no
+   * accepted strings.
+   */
+  bool nearMiss(int minLength, int maxLength, std::string &out);
+
+  /**
+   * @brief Appends count strings back to back to bytes, each one a near miss
+   * with probability nearMissRate, and their end offsets to ends. Returns
+   * the number generated (0 if the range has no accepted strings).
+   */
+  size_t generate(size_t count, int minLength, int maxLength,
+                  double nearMissRate, std::string &bytes,
+                  std::vector<int32_t> &ends);
+
+private:
+  // Transitions of a state grouped by target: symbols[first, first + size)
+  struct Group {
+    int32_t target;
+    int32_t first;
+    int32_t size;
+  };
+
+  std::vector<uint8_t> accepting;
+  std::vector<std::vector<Group>> groups;
+  std::vector<char> symbols;
+  std::vector<int32_t> table; // table[state * 256 + byte], -1 = reject
+  std::string alphabet;
+  int32_t start = -1;
+
+  int tableLength;
+  std::vector<double> logWeights; // [k * n + s] = log2 W[k][s], -inf if 0
+  std::vector<double> lengthCdf; // Cached for cdfMin..cdfMax
+  int cdfMin = -1, cdfMax = -1;
+  std::mt19937_64 rng;
+
+  bool accepts(const std::string &input) const;
+  int pickLength(int minLength, int maxLength);
+  void walk(int length, std::string &out);
+};
+
+} // namespace FormalSystem
+
+#endif // LANGUAGE_SAMPLER_H
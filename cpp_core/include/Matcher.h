@@ -1,7 +1,10 @@
 #ifndef MATCHER_H
 #define MATCHER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace FormalSystem {
 
@@ -13,6 +16,16 @@ public:
    */
   static bool approximateMatch(const std::string &text,
                                const std::string &pattern, int maxErrors);
+  static bool approximateMatch(const char *text, size_t length,
+                               const std::string &pattern, int maxErrors);
+
+  /**
+   * @brief Collects every end offset i (0..length) such that some substring
+   * text[s..i) is within maxErrors of the pattern. Returns the count.
+   */
+  static size_t approximateMatchEnds(const char *text, size_t length,
+                                     const std::string &pattern, int maxErrors,
+                                     std::vector<int32_t> &ends);
 };
 
 } // namespace FormalSystem
@@ -1,12 +1,155 @@
 #ifndef PDA_H
 #define PDA_H
 
+#include <cstddef>
+#include <cstdint>
+#include <set>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace FormalSystem {
 
+/**
+ * @brief General pushdown automaton over integer input and stack symbols.
+ *
+ * The transition relation is an explicit table. If no two transitions can
+ * apply to the same configuration, run() uses a deterministic fast path
+ * with an indexed table and a plain vector stack. Otherwise it explores
+ * configurations breadth-first, sharing stacks as interned linked nodes
+ * and skipping configurations already seen at the same input position.
+ */
+class PushdownAutomaton {
+public:
+  static constexpr int EPSILON = -1; // Input: consume nothing
+  static constexpr int ANY = -2;     // Input: any symbol; top: no condition
+  static constexpr int EMPTY = -3;   // Top: stack must be empty
+
+  /**
+   * @brief Explored configurations before the nondeterministic mode gives up.
+   */
+  static constexpr size_t MAX_CONFIGURATIONS = 1000000;
+
+  struct Transition {
+    int from;
+    int input; // Symbol, EPSILON or ANY
+    int top;   // Symbol, ANY or EMPTY
+    int to;
+    bool pop;              // Pop the top first (stack must be non-empty)
+    std::vector<int> push; // Pushed in order; the last one ends on top
+  };
+
+  struct Result {
+    bool accepted;
+    size_t position; // Input symbols consumed when the run stopped
+    int state;       // Deterministic mode: state when the run stopped
+    int top;         // Deterministic mode: stack top then, EMPTY if none
+    size_t stackDepth;
+  };
+
+  std::vector<Transition> transitions;
+  int startState = 0;
+  std::set<int> acceptStates;     // Empty: every state accepts
+  bool acceptOnEmptyStack = true; // Also require an empty stack at the end
+  std::vector<std::string> inputNames; // Optional names used in logs
+  std::vector<std::string> stackNames;
+
+  void addTransition(int from, int input, int top, int to, bool pop,
+                     std::vector<int> push = {});
+  bool isDeterministic() const;
+
+  Result run(const std::vector<int> &input,
+             std::vector<std::string> *log = nullptr) const;
+  Result runDeterministic(const std::vector<int> &input,
+                          std::vector<std::string> *log = nullptr) const;
+  Result runNondeterministic(const std::vector<int> &input,
+                             std::vector<std::string> *log = nullptr) const;
+
+private:
+  struct Key {
+    int from, input, top;
+    bool operator==(const Key &o) const {
+      return from == o.from && input == o.input && top == o.top;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key &k) const {
+      return (static_cast<size_t>(k.from) * 1000003u) ^
+             (static_cast<size_t>(k.input) * 10007u) ^
+             static_cast<size_t>(k.top);
+    }
+  };
+
+  mutable int deterministic = -1; // Cached isDeterministic(), -1 = unknown
+  mutable std::unordered_map<Key, int, KeyHash> index;
+
+  const Transition *find(int state, int input, int top) const;
+  bool accepts(int state, bool stackEmpty) const;
+  std::string inputName(int symbol) const;
+  std::string stackName(int symbol) const;
+};
+
+/**
+ * @brief Fixed-capacity ring buffer of binary PDA trace events.
+ *
+ * Storage is allocated once, by the constructor; record() only writes into
+ * it and overwrites the oldest events when full. A disabled buffer records
+ * nothing. Events are four int32 fields, so the storage can be handed to JS
+ * as an Int32Array view without copying.
+ */
+class PDATrace {
+public:
+  enum Op : int32_t {
+    Start,
+    Push,
+    Pop,
+    RejectEmptyStack, // Pop on an empty stack
+    RejectInput,      // Input not fully consumed
+    RejectStack,      // Stack not empty at the end
+    Accept
+  };
+
+  struct Event {
+    int32_t op;
+    int32_t symbol; // Input symbol read, 0 if none
+    int32_t depth;  // Stack depth after the step
+    int32_t position;
+  };
+  static constexpr int FIELDS = 4; // int32 values per event
+  static_assert(sizeof(Event) == FIELDS * sizeof(int32_t),
+                "Event must be a packed int32 record");
+
+  explicit PDATrace(size_t capacity = 4096);
+
+  bool enabled = true;
+
+  void record(Op op, int32_t symbol, size_t depth, size_t position) {
+    if (!enabled || events.empty())
+      return;
+    events[next] = {op, symbol, static_cast<int32_t>(depth),
+                    static_cast<int32_t>(position)};
+    next = next + 1 == events.size() ? 0 : next + 1;
+    total++;
+  }
+
+  void clear();
+  size_t capacity() const { return events.size(); }
+  size_t size() const { return total < events.size() ? total : events.size(); }
+  size_t dropped() const { return total - size(); }
+
+  /**
+   * @brief The retained events, oldest first. Rotates the ring in place if it
+   * has wrapped, so the pointer stays valid until the next record().
+   */
+  const Event *data();
+
+private:
+  std::vector<Event> events;
+  size_t next = 0;
+  size_t total = 0;
+};
+
 class PDA {
 public:
   /**
@@ -14,6 +157,33 @@ public:
    * Logs stack operations for visualization.
    */
   bool simulate(const std::string &input, std::vector<std::string> &log);
+
+  /**
+   * @brief Same PDA; records binary events instead of building strings.
+   * Pass nullptr (or a disabled trace) to skip tracing altogether.
+   */
+  bool simulate(const std::string &input, PDATrace *trace = nullptr);
+  bool simulate(const char *input, size_t length, PDATrace *trace = nullptr);
+
+  /**
+   * @brief Formats a simulate() trace event as its log line.
+   */
+  static std::string describe(const PDATrace::Event &event);
+
+  /**
+   * @brief Balanced parentheses / RNA dot-bracket check. Any character other
+   * than '(' and ')' is an unpaired base. A pair enclosing no other pair must
+   * enclose at least minLoop bases (hairpin loop constraint).
+   */
+  bool checkBalanced(const std::string &input, std::vector<std::string> &log,
+                     int minLoop = 3);
+
+  /**
+   * @brief Checks that XML-like tags nest properly. Attributes and text are
+   * ignored, self-closing tags are skipped, and tag names are interned to
+   * integer stack symbols.
+   */
+  bool checkXML(const std::string &input, std::vector<std::string> &log);
 };
 
 } // namespace FormalSystem
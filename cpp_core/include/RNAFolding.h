@@ -0,0 +1,61 @@
+#ifndef RNA_FOLDING_H
+#define RNA_FOLDING_H
+
+#include <cstddef>
+#include <string>
+
+namespace FormalSystem {
+
+/**
+ * @brief Nussinov RNA secondary structure prediction.
+ *
+ * Maximizes the number of base pairs (or, with weighted scoring, a
+ * hydrogen-bond count: GC 3, AU 2, GU 1) subject to the hairpin constraint
+ * that a pair encloses at least minLoop unpaired bases. The O(n^3) table is
+ * split into square blocks; blocks on the same block anti-diagonal are
+ * independent and are filled by a pool of threads. Each cell's
+ * bifurcation loop reads a row and a transposed column copy of the table,
+ * so both operands are contiguous.
+ *
+ * The result is a dot-bracket string accepted by PDA::checkBalanced with
+ * the same minLoop.
+ */
+class NussinovFolder {
+public:
+  struct Options {
+    int minLoop = 3;
+    bool wobble = true;    // Allow G-U pairs
+    bool weighted = false; // Score pairs by hydrogen bonds instead of 1
+    int threads = 0;       // 0 = hardware concurrency
+    int blockSize = 64;
+  };
+
+  struct Result {
+    std::string structure; // Dot-bracket, one character per base
+    int score;
+    int pairs;
+  };
+
+  /**
+   * @brief Longest sequence accepted; keeps scores within int16 cells.
+   */
+  static const size_t MAX_LENGTH = 10000;
+
+  NussinovFolder();
+  explicit NussinovFolder(Options options);
+
+  /**
+   * @brief Folds a sequence of A, C, G, U (T is read as U, case ignored).
+   * Any other character stays unpaired.
+   */
+  Result fold(const std::string &sequence) const;
+
+  int pairScore(char a, char b) const;
+
+private:
+  Options options;
+};
+
+} // namespace FormalSystem
+
+#endif // RNA_FOLDING_H
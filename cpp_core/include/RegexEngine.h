@@ -2,19 +2,48 @@
 #define REGEX_ENGINE_H
 
 #include "Automaton.h"
+#include "CaptureNFA.h"
+#include "CountingAutomaton.h"
+#include "Utf8.h"
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace FormalSystem {
 
+/**
+ * @brief One element of a regex in postfix (reverse Polish) order.
+ */
+struct RegexToken {
+  enum Type { Literal, Concat, Union, Star, Repeat, Group, Class };
+
+  Type type;
+  char symbol = 0; // Literal
+  int min = 0;     // Repeat: lower bound
+  int max = 0;     // Repeat: upper bound, -1 when unbounded ({m,})
+  int group = 0;   // Group: capture group number (1-based, by '(' order)
+  std::shared_ptr<const Utf8Automaton> bytes; // Class: UTF-8 byte automaton
+};
+
 class RegexEngine {
 public:
+  /**
+   * @brief Upper bound on the states produced when a bounded repetition is
+   * expanded by copying. Larger repetitions must use regexToCountingNFA.
+   */
+  static const int MAX_EXPANDED_STATES = 20000;
+
   /**
    * @brief Converts a regex string to an NFA using Thompson's construction.
    * Supports:
    *  - Concatenation (implicit)
    *  - Union (|)
    *  - Kleene Star (*)
+   *  - Bounded repetition ({n}, {m,n}, {m,}), expanded by copying
    *  - Parentheses ()
+   *  - Codepoint classes ([a-z], [^...], [α-ω]), escapes (\u{1F600},
+   *    \u00E9, \n, \t, \r, \* and other punctuation) and non-ASCII
+   *    characters, matched as UTF-8 byte sequences
    */
   static NFA regexToNFA(const std::string &regex);
 
@@ -23,6 +52,24 @@ public:
    */
   static DFA nfaToDFA(const NFA &nfa);
 
+  /**
+   * @brief Builds a counter-augmented NFA. Bounded repetitions keep a counter
+   * instead of copying states, so the automaton size does not depend on the
+   * repetition bounds.
+   */
+  static CountingNFA regexToCountingNFA(const std::string &regex);
+
+  /**
+   * @brief Builds a Thompson program with capture groups. Every '(' opens a
+   * numbered group (1-based, in order of '('); group 0 is the whole match.
+   */
+  static CaptureNFA regexToCaptureNFA(const std::string &regex);
+
+  /**
+   * @brief Parses a regex into postfix tokens (shared by all compilers).
+   */
+  static std::vector<RegexToken> toPostfixTokens(const std::string &regex);
+
 private:
   static std::string preprocessRegex(const std::string &regex);
   static std::string toPostfix(const std::string &regex);
@@ -0,0 +1,205 @@
+#ifndef STATIC_REGEX_H
+#define STATIC_REGEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace FormalSystem {
+
+/**
+ * @brief DFA built entirely at compile time from a string-literal pattern.
+ *
+ * Usage:
+ *   static constexpr auto kAbb = compileStaticRegex("(a|b)*abb");
+ *   static_assert(kAbb.match("aabb"));
+ *
+ * Supports the same syntax as RegexEngine minus bounded repetition and
+ * capture extraction: alphanumeric literals, concatenation, '|', '*' and
+ * parentheses. The table is indexed by symbol class, so its size only
+ * depends on the distinct symbols in the pattern. Invalid patterns or
+ * patterns exceeding the capacities fail to compile.
+ */
+template <size_t MaxStates = 64, size_t MaxClasses = 16> struct StaticDFA {
+  uint8_t classOf[256] = {}; // Byte -> symbol class, 0 = not in pattern
+  int16_t next[MaxStates][MaxClasses] = {}; // -1 = dead
+  bool accepting[MaxStates] = {};
+  int stateCount = 0;
+  int classCount = 1;
+
+  constexpr bool match(std::string_view input) const {
+    int state = 0;
+    for (char c : input) {
+      state = next[state][classOf[static_cast<unsigned char>(c)]];
+      if (state < 0)
+        return false;
+    }
+    return accepting[state];
+  }
+};
+
+namespace detail {
+
+// Position (Glushkov) automaton: one position per literal, no epsilons.
+// Bit 63 of a state mask stands for the start state.
+constexpr int MAX_POSITIONS = 63;
+constexpr uint64_t START_BIT = uint64_t(1) << 63;
+
+struct PositionSets {
+  bool nullable = true;
+  uint64_t first = 0;
+  uint64_t last = 0;
+};
+
+struct GlushkovParser {
+  std::string_view s;
+  size_t i = 0;
+  int positions = 0;
+  char symbol[MAX_POSITIONS] = {};
+  uint64_t follow[MAX_POSITIONS] = {};
+
+  constexpr explicit GlushkovParser(std::string_view pattern) : s(pattern) {}
+
+  static constexpr bool isLiteral(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9');
+  }
+
+  constexpr void addFollow(uint64_t from, uint64_t to) {
+    for (int p = 0; p < positions; ++p) {
+      if (from & (uint64_t(1) << p))
+        follow[p] |= to;
+    }
+  }
+
+  // union := concat ('|' concat)*
+  constexpr PositionSets parseUnion() {
+    PositionSets result = parseConcat();
+    while (i < s.size() && s[i] == '|') {
+      ++i;
+      PositionSets rhs = parseConcat();
+      result.nullable = result.nullable || rhs.nullable;
+      result.first |= rhs.first;
+      result.last |= rhs.last;
+    }
+    return result;
+  }
+
+  // concat := star*
+  constexpr PositionSets parseConcat() {
+    PositionSets result; // Empty string
+    while (i < s.size() && s[i] != '|' && s[i] != ')') {
+      PositionSets rhs = parseStar();
+      addFollow(result.last, rhs.first);
+      uint64_t first = result.first | (result.nullable ? rhs.first : 0);
+      uint64_t last = rhs.last | (rhs.nullable ? result.last : 0);
+      result = {result.nullable && rhs.nullable, first, last};
+    }
+    return result;
+  }
+
+  // star := atom '*'*
+  constexpr PositionSets parseStar() {
+    PositionSets result = parseAtom();
+    while (i < s.size() && s[i] == '*') {
+      ++i;
+      addFollow(result.last, result.first);
+      result.nullable = true;
+    }
+    return result;
+  }
+
+  // atom := literal | '(' union ')'
+  constexpr PositionSets parseAtom() {
+    char c = s[i];
+    if (c == '(') {
+      ++i;
+      PositionSets inner = parseUnion();
+      if (i >= s.size() || s[i] != ')')
+        throw std::logic_error("Mismatched parentheses: Missing ')'");
+      ++i;
+      return inner;
+    }
+    if (!isLiteral(c))
+      throw std::logic_error("Unsupported character in static regex");
+    if (positions == MAX_POSITIONS)
+      throw std::logic_error("Static regex has too many literals");
+    ++i;
+    symbol[positions] = c;
+    uint64_t bit = uint64_t(1) << positions++;
+    return {false, bit, bit};
+  }
+};
+
+} // namespace detail
+
+/**
+ * @brief Parses the pattern and runs subset construction over the position
+ * automaton, all in a constant expression.
+ */
+template <size_t MaxStates = 64, size_t MaxClasses = 16>
+constexpr StaticDFA<MaxStates, MaxClasses>
+compileStaticRegex(std::string_view pattern) {
+  using detail::START_BIT;
+  detail::GlushkovParser parser(pattern);
+  detail::PositionSets root = parser.parseUnion();
+  if (parser.i != pattern.size())
+    throw std::logic_error("Mismatched parentheses: Missing '('");
+
+  StaticDFA<MaxStates, MaxClasses> dfa;
+
+  // One class per distinct symbol; positionsOf[c] = positions reading class c
+  uint64_t positionsOf[MaxClasses] = {};
+  for (int p = 0; p < parser.positions; ++p) {
+    auto byte = static_cast<unsigned char>(parser.symbol[p]);
+    if (dfa.classOf[byte] == 0) {
+      if (dfa.classCount == static_cast<int>(MaxClasses))
+        throw std::logic_error("Static regex has too many distinct symbols");
+      dfa.classOf[byte] = dfa.classCount++;
+    }
+    positionsOf[dfa.classOf[byte]] |= uint64_t(1) << p;
+  }
+
+  uint64_t masks[MaxStates] = {};
+  masks[0] = START_BIT;
+  dfa.stateCount = 1;
+
+  for (int s = 0; s < dfa.stateCount; ++s) {
+    uint64_t mask = masks[s];
+    dfa.accepting[s] =
+        (mask & root.last) != 0 || (mask == START_BIT && root.nullable);
+    dfa.next[s][0] = -1;
+
+    for (int c = 1; c < dfa.classCount; ++c) {
+      uint64_t reachable = (mask & START_BIT) ? root.first : 0;
+      for (int p = 0; p < parser.positions; ++p) {
+        if (mask & (uint64_t(1) << p))
+          reachable |= parser.follow[p];
+      }
+      uint64_t target = reachable & positionsOf[c];
+      if (target == 0) {
+        dfa.next[s][c] = -1;
+        continue;
+      }
+
+      int found = -1;
+      for (int t = 0; t < dfa.stateCount && found == -1; ++t) {
+        if (masks[t] == target)
+          found = t;
+      }
+      if (found == -1) {
+        if (dfa.stateCount == static_cast<int>(MaxStates))
+          throw std::logic_error("Static regex needs more DFA states");
+        found = dfa.stateCount++;
+        masks[found] = target;
+      }
+      dfa.next[s][c] = found;
+    }
+  }
+  return dfa;
+}
+
+} // namespace FormalSystem
+
+#endif // STATIC_REGEX_H
@@ -0,0 +1,78 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Build with -DFS_STATS=1 (make STATS=1) to collect engine counters. In
+// default builds the FS_STAT_* macros expand to nothing and their arguments
+// are never evaluated.
+#ifndef FS_STATS
+#define FS_STATS 0
+#endif
+
+namespace FormalSystem {
+
+struct EngineStats {
+  enum Phase { Parse, Determinize, Simulate, Match, PHASES };
+
+  uint64_t nfaStates = 0;     // NFA states created by regexToNFA
+  uint64_t nfaEdges = 0;      // Symbol and epsilon edges created
+  uint64_t dfaStates = 0;     // States produced by subset construction
+  uint64_t closureCalls = 0;  // Epsilon-closure computations
+  uint64_t closureStates = 0; // States added by epsilon closures
+  uint64_t bytesScanned = 0;  // Input bytes consumed by simulate / match
+  uint64_t transitions = 0;   // Transitions taken (DFA) or followed (NFA)
+  uint64_t cacheHits = 0;     // Memoized DFA transitions reused
+  uint64_t cacheMisses = 0;   // Memoized DFA transitions computed
+  uint64_t dpCells = 0;       // Matcher DP cells computed
+  double phaseMillis[PHASES] = {};
+};
+
+/**
+ * @brief Per-thread engine counters. Only filled in FS_STATS builds;
+ * otherwise current() stays all zeros.
+ */
+class Stats {
+public:
+  static constexpr bool enabled = FS_STATS != 0;
+
+  static EngineStats &current();
+  static void reset();
+  static std::string report();
+
+  /**
+   * @brief Adds the lifetime of the object to a phase total.
+   */
+  class PhaseTimer {
+  public:
+    explicit PhaseTimer(EngineStats::Phase phase)
+        : phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+      std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - start;
+      current().phaseMillis[phase] += elapsed.count();
+    }
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+  private:
+    EngineStats::Phase phase;
+    std::chrono::steady_clock::time_point start;
+  };
+};
+
+} // namespace FormalSystem
+
+#if FS_STATS
+#define FS_STAT_ADD(field, n) (::FormalSystem::Stats::current().field += (n))
+#define FS_STAT_PHASE(phase)                                                   \
+  ::FormalSystem::Stats::PhaseTimer fsPhaseTimer(                              \
+      ::FormalSystem::EngineStats::phase)
+#else
+#define FS_STAT_ADD(field, n) ((void)0)
+#define FS_STAT_PHASE(phase) ((void)0)
+#endif
+
+#endif // STATS_H
@@ -0,0 +1,113 @@
+#ifndef STREAMING_VALIDATOR_H
+#define STREAMING_VALIDATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Deterministic PDA that checks nesting over input fed in chunks.
+ *
+ * XML mode checks open/close tags (attributes, text, comments, CDATA,
+ * processing instructions and self-closing tags are skipped). JSON mode
+ * checks '{' / '[' against '}' / ']' outside string literals. The lexer is
+ * a byte-at-a-time state machine, so tokens may span chunk boundaries.
+ * Names are interned to integer IDs and the stack holds only IDs, so memory
+ * is O(nesting depth + distinct names), independent of the input size.
+ * Validation stops at the first error; its byte offset is reported.
+ */
+class StreamingTagValidator {
+public:
+  enum Mode { XML, JSON };
+  enum Status {
+    Ok,
+    Mismatch,        // Closing tag/bracket does not match the open one
+    UnexpectedClose, // Closing tag/bracket with an empty stack
+    Unclosed,        // Input ended with open tags/brackets
+    Unterminated,    // Input ended inside a tag, comment or string
+    NameTooLong
+  };
+
+  struct Result {
+    bool valid;
+    Status status;
+    uint64_t errorOffset; // Byte offset of the offending token
+    size_t depth;         // Stack depth when validation stopped
+    size_t maxDepth;
+    std::string message;
+  };
+
+  /**
+   * @brief Longest tag name accepted, so a malformed tag cannot grow memory.
+   */
+  static const size_t MAX_NAME_LENGTH = 1024;
+
+  explicit StreamingTagValidator(Mode mode = XML);
+
+  void reset();
+
+  /**
+   * @brief Consumes the next chunk. Returns false once an error was found;
+   * later chunks are then ignored.
+   */
+  bool feed(const char *data, size_t length);
+  bool feed(const std::string &chunk) {
+    return feed(chunk.data(), chunk.size());
+  }
+
+  /**
+   * @brief Ends the input and reports the outcome. Also valid mid-stream
+   * for a snapshot; call reset() before reusing the validator.
+   */
+  Result finish() const;
+
+  size_t depth() const { return stack.size(); }
+  uint64_t bytesConsumed() const { return offset; }
+
+private:
+  enum LexState {
+    Text,
+    TagOpen,   // After '<'
+    TagName,   // Reading the name of an open/close tag
+    TagRest,   // Attributes up to '>'
+    TagQuote,  // Quoted attribute value
+    SkipUntil, // Comment, CDATA, declaration or processing instruction
+    String,    // JSON string literal
+    Escape     // After '\' in a JSON string
+  };
+
+  Mode mode;
+  LexState state;
+  uint64_t offset;     // Bytes consumed so far
+  uint64_t tokenStart; // Offset of the '<' or '"' being lexed
+  bool closing;
+  char lastNonSpace;
+  char quote;
+  const char *terminator; // SkipUntil: end marker and matched prefix length
+  size_t matched;
+  std::string name;
+
+  std::unordered_map<std::string, int32_t> ids;
+  std::vector<std::string> names; // ID -> name, for messages
+  std::vector<int32_t> stack;
+  size_t maxDepth;
+
+  Status status;
+  uint64_t errorOffset;
+  std::string message;
+
+  void step(char c);
+  void startSkip(const char *end);
+  void openTag();
+  void closeTag();
+  void fail(Status error, uint64_t at, const std::string &text);
+  int32_t intern(const std::string &symbol);
+};
+
+} // namespace FormalSystem
+
+#endif // STREAMING_VALIDATOR_H
@@ -0,0 +1,79 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace FormalSystem {
+
+/**
+ * @brief Set of Unicode codepoints kept as sorted, disjoint, non-adjacent
+ * ranges.
+ */
+class CodepointSet {
+public:
+  static const uint32_t MAX_CODEPOINT = 0x10FFFF;
+
+  /**
+   * @brief Adds [lo, hi]. Throws std::runtime_error past U+10FFFF or if
+   * lo > hi.
+   */
+  void add(uint32_t lo, uint32_t hi);
+  void add(uint32_t codepoint) { add(codepoint, codepoint); }
+
+  /**
+   * @brief Complement within U+0000..U+10FFFF.
+   */
+  void negate();
+
+  bool empty() const { return ranges_.empty(); }
+  bool contains(uint32_t codepoint) const;
+  const std::vector<std::pair<uint32_t, uint32_t>> &ranges() const {
+    return ranges_;
+  }
+
+private:
+  std::vector<std::pair<uint32_t, uint32_t>> ranges_;
+};
+
+/**
+ * @brief Minimal acyclic byte automaton accepting exactly the UTF-8
+ * encodings of a CodepointSet (surrogates U+D800..U+DFFF are never encoded).
+ *
+ * Codepoint ranges are split into byte-range sequences (at most 4 ranges
+ * each), inserted into a trie and then hash-consed bottom-up, so equal
+ * suffixes such as the trailing [80-BF] bytes are shared. Node 0 is the
+ * accepting node and has no edges; edges always go to lower IDs and the
+ * start is the last node.
+ */
+struct Utf8Automaton {
+  struct Edge {
+    unsigned char lo;
+    unsigned char hi;
+    int target;
+  };
+
+  std::vector<std::vector<Edge>> nodes;
+
+  int start() const { return static_cast<int>(nodes.size()) - 1; }
+
+  /**
+   * @brief Throws std::runtime_error if the set encodes no codepoint.
+   */
+  static Utf8Automaton compile(const CodepointSet &set);
+};
+
+/**
+ * @brief Decodes the UTF-8 sequence at text[i] and advances i past it.
+ * Throws std::runtime_error on malformed, overlong or surrogate sequences.
+ */
+uint32_t decodeUtf8(const std::string &text, size_t &i);
+
+std::string encodeUtf8(uint32_t codepoint);
+
+} // namespace FormalSystem
+
+#endif // UTF8_H
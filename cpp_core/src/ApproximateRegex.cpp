@@ -0,0 +1,298 @@
+#include "ApproximateRegex.h"
+#include "RegexEngine.h"
+#include "Stats.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace FormalSystem {
+
+ApproximateRegex::ApproximateRegex(const NFA &nfa, int maxErrors)
+    : errors(maxErrors) {
+  if (maxErrors < 0)
+    throw std::runtime_error("Max errors must be non-negative");
+  build(nfa);
+}
+
+ApproximateRegex::ApproximateRegex(const std::string &regex, int maxErrors)
+    : ApproximateRegex(RegexEngine::regexToNFA(regex), maxErrors) {}
+
+// ====================== Bit Layout ======================
+
+void ApproximateRegex::build(const NFA &nfa) {
+  if (!nfa.startState)
+    return;
+  std::unordered_map<const State *, int> index;
+  std::vector<const State *> byIndex;
+  auto add = [&](const State *state) {
+    if (index.emplace(state, byIndex.size()).second)
+      byIndex.push_back(state);
+  };
+  add(nfa.startState.get());
+  for (const auto &state : nfa.allStates)
+    add(state.get());
+  int n = byIndex.size();
+
+  // Chain each state to its symbol successor when that successor is its
+  // only one and has no other symbol predecessor (always so for Thompson)
+  std::vector<int> next(n, -1), sources(n, 0);
+  for (int s = 0; s < n; ++s) {
+    int target = -1;
+    bool single = true;
+    for (const auto &[symbol, targets] : byIndex[s]->transitions) {
+      for (const auto &t : targets) {
+        int ti = index.at(t.get());
+        single = single && (target == -1 || target == ti);
+        target = ti;
+      }
+    }
+    if (target != -1) {
+      sources[target]++;
+      if (single)
+        next[s] = target;
+    }
+  }
+  std::vector<bool> linked(n, false); // Goes right after its predecessor
+  for (int s = 0; s < n; ++s) {
+    if (next[s] != -1 && sources[next[s]] == 1)
+      linked[next[s]] = true;
+  }
+  std::vector<int> pos(n, -1);
+  int placed = 0;
+  for (int head = 0; head < n; ++head) {
+    if (linked[head])
+      continue;
+    for (int s = head; s != -1 && pos[s] == -1;
+         s = next[s] != -1 && linked[next[s]] ? next[s] : -1)
+      pos[s] = placed++;
+  }
+  for (int s = 0; s < n; ++s) { // Symbol-edge cycles (not from Thompson)
+    if (pos[s] == -1)
+      pos[s] = placed++;
+  }
+
+  states = n;
+  words = (n + 63) / 64;
+  auto setBit = [](Word *bits, int bit) {
+    bits[bit / 64] |= Word(1) << (bit % 64);
+  };
+  symbolMask.assign(256 * words, 0);
+  anyMask.assign(words, 0);
+  finalMask.assign(words, 0);
+  for (int s = 0; s < n; ++s) {
+    for (const auto &[symbol, targets] : byIndex[s]->transitions) {
+      unsigned char c = symbol;
+      for (const auto &t : targets) {
+        int to = pos[index.at(t.get())];
+        if (to == pos[s] + 1) {
+          setBit(&symbolMask[c * words], pos[s]);
+          setBit(anyMask.data(), pos[s]);
+        } else {
+          extraEdges.push_back({pos[s], to, c});
+        }
+      }
+    }
+  }
+  for (const auto &state : nfa.finalStates)
+    setBit(finalMask.data(), pos[index.at(state.get())]);
+
+  // Epsilon closure of each single state
+  std::vector<Word> single(static_cast<size_t>(n) * words, 0);
+  std::vector<int> stack;
+  for (int s = 0; s < n; ++s) {
+    Word *bits = &single[static_cast<size_t>(pos[s]) * words];
+    setBit(bits, pos[s]);
+    stack.assign(1, s);
+    while (!stack.empty()) {
+      const State *state = byIndex[stack.back()];
+      stack.pop_back();
+      for (const auto &t : state->epsilonTransitions) {
+        int ti = index.at(t.get());
+        if (!(bits[pos[ti] / 64] >> (pos[ti] % 64) & 1)) {
+          setBit(bits, pos[ti]);
+          stack.push_back(ti);
+        }
+      }
+    }
+  }
+
+  // Up to 1024 states, one closure per value of each 8-bit chunk; beyond,
+  // one per state
+  chunked = n <= 1024;
+  if (chunked) {
+    size_t chunks = words * 64 / CHUNK_BITS;
+    closures.assign((chunks << CHUNK_BITS) * words, 0);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+      Word *table = &closures[(chunk << CHUNK_BITS) * words];
+      for (int value = 1; value < (1 << CHUNK_BITS); ++value) {
+        // value = (value without its lowest bit) + lowest bit
+        int low = __builtin_ctz(value);
+        size_t state = chunk * CHUNK_BITS + low;
+        const Word *rest = &table[(value & (value - 1)) * words];
+        Word *out = &table[value * words];
+        for (int w = 0; w < words; ++w)
+          out[w] = rest[w] |
+                   (state < static_cast<size_t>(n) ? single[state * words + w]
+                                                   : 0);
+      }
+    }
+  } else {
+    closures.swap(single);
+  }
+
+  // Level i starts with everything i deletions away from the start
+  initial.assign((errors + 1) * words, 0);
+  std::vector<Word> start(words, 0), moved(words);
+  setBit(start.data(), pos[0]);
+  close<0>(start.data(), &initial[0]);
+  for (int i = 1; i <= errors; ++i) {
+    const Word *prev = &initial[(i - 1) * words];
+    std::fill(moved.begin(), moved.end(), 0);
+    move<0>(prev, -1, moved.data());
+    close<0>(moved.data(), &initial[i * words]);
+    for (int w = 0; w < words; ++w)
+      initial[i * words + w] |= prev[w];
+  }
+}
+
+// ====================== Bit-Parallel Steps ======================
+
+// The step loops take the word count as a template argument so that
+// patterns of up to 128 states run fully unrolled; 0 means this->words
+template <int W>
+inline void ApproximateRegex::close(const Word *in, Word *out) const {
+  const int n = W ? W : words;
+  std::fill(out, out + n, 0);
+  for (int w = 0; w < n; ++w) {
+    Word bits = in[w];
+    if (chunked) {
+      // Small sets look up every chunk (entry 0 is empty) rather than
+      // branch on which ones are zero
+      for (int chunk = w * (64 / CHUNK_BITS); W ? chunk < (w + 1) * 8 : bits;
+           ++chunk, bits >>= CHUNK_BITS) {
+        size_t value = bits & ((1 << CHUNK_BITS) - 1);
+        if (!W && value == 0)
+          continue;
+        const Word *add = &closures[((chunk << CHUNK_BITS) + value) * n];
+        for (int v = 0; v < n; ++v)
+          out[v] |= add[v];
+      }
+    } else {
+      for (; bits != 0; bits &= bits - 1) {
+        size_t state = w * 64 + __builtin_ctzll(bits);
+        const Word *add = &closures[state * n];
+        for (int v = 0; v < n; ++v)
+          out[v] |= add[v];
+      }
+    }
+  }
+}
+
+// out |= states reached from in by one edge on symbol (-1: any symbol)
+template <int W>
+inline void ApproximateRegex::move(const Word *in, int symbol,
+                                   Word *out) const {
+  const int n = W ? W : words;
+  const Word *mask = symbol < 0 ? anyMask.data() : &symbolMask[symbol * n];
+  Word carry = 0;
+  for (int w = 0; w < n; ++w) {
+    Word bits = in[w] & mask[w];
+    out[w] |= bits << 1 | carry;
+    carry = bits >> 63;
+  }
+  for (const auto &e : extraEdges) {
+    bool active = in[e.from / 64] >> (e.from % 64) & 1;
+    if (active && (symbol < 0 || e.symbol == symbol))
+      out[e.to / 64] |= Word(1) << (e.to % 64);
+  }
+}
+
+// R[i] holds the states reachable with at most i errors. Per byte c:
+//   R'[0] = close(move(R[0], c)) | initial[0]
+//   R'[i] = close(move(R[i], c)        match
+//               | move(R[i-1], any)   substitution
+//               | move(R'[i-1], any)) deletion (regex symbol skipped)
+//           | R[i-1]                  insertion (text byte skipped)
+template <int W, typename OnEnd>
+void ApproximateRegex::scan(const char *text, size_t length,
+                            OnEnd onEnd) const {
+  const int n = W ? W : words;
+  size_t levels = errors + 1;
+  std::vector<Word> current(initial), updated(levels * n), moved(n), below(n);
+  auto accepting = [&](const std::vector<Word> &sets) {
+    const Word *last = &sets[errors * n];
+    Word any = 0;
+    for (int w = 0; w < n; ++w)
+      any |= last[w] & finalMask[w];
+    return any != 0;
+  };
+  if (accepting(current) && !onEnd(0))
+    return;
+
+  size_t i = 1;
+  for (; i <= length; ++i) {
+    unsigned char c = text[i - 1];
+    for (size_t level = 0; level < levels; ++level) {
+      const Word *from = &current[level * n];
+      Word *to = &updated[level * n];
+      std::fill(moved.begin(), moved.end(), 0);
+      move<W>(from, c, moved.data());
+      if (level > 0) {
+        // Substitution and deletion both take any edge: move their union
+        for (int w = 0; w < n; ++w)
+          below[w] = from[w - n] | to[w - n];
+        move<W>(below.data(), -1, moved.data());
+      }
+      close<W>(moved.data(), to);
+      const Word *extra = level > 0 ? from - n : &initial[0];
+      for (int w = 0; w < n; ++w)
+        to[w] |= extra[w];
+    }
+    current.swap(updated);
+    if (accepting(current) && !onEnd(i))
+      break;
+  }
+  FS_STAT_ADD(bytesScanned, std::min(i, length));
+}
+
+template <typename OnEnd>
+void ApproximateRegex::scan(const char *text, size_t length,
+                            OnEnd onEnd) const {
+  if (states == 0)
+    return;
+  if (words == 1)
+    scan<1>(text, length, onEnd);
+  else if (words == 2)
+    scan<2>(text, length, onEnd);
+  else
+    scan<0>(text, length, onEnd);
+}
+
+// ====================== Search ======================
+
+bool ApproximateRegex::search(const std::string &text) const {
+  return search(text.data(), text.size());
+}
+
+bool ApproximateRegex::search(const char *text, size_t length) const {
+  FS_STAT_PHASE(Match);
+  bool found = false;
+  scan(text, length, [&](size_t) {
+    found = true;
+    return false;
+  });
+  return found;
+}
+
+size_t ApproximateRegex::matchEnds(const char *text, size_t length,
+                                   std::vector<int32_t> &ends) const {
+  FS_STAT_PHASE(Match);
+  ends.clear();
+  scan(text, length, [&](size_t i) {
+    ends.push_back(static_cast<int32_t>(i));
+    return true;
+  });
+  return ends.size();
+}
+
+} // namespace FormalSystem
@@ -1,4 +1,5 @@
 #include "Automaton.h"
+#include "Stats.h"
 #include <algorithm>
 #include <iomanip>
 #include <queue>
@@ -20,14 +21,17 @@ void NFA::addTransition(std::shared_ptr<State> from, char symbol,
                         std::shared_ptr<State> to) {
   from->transitions[symbol].push_back(to);
   alphabet.insert(symbol);
+  FS_STAT_ADD(nfaEdges, 1);
 }
 
 void NFA::addEpsilonTransition(std::shared_ptr<State> from,
                                std::shared_ptr<State> to) {
   from->epsilonTransitions.push_back(to);
+  FS_STAT_ADD(nfaEdges, 1);
 }
 
 void NFA::getEpsilonClosure(std::set<std::shared_ptr<State>> &currentStates) {
+  FS_STAT_ADD(closureCalls, 1);
   std::queue<std::shared_ptr<State>> q;
   for (const auto &s : currentStates) {
     q.push(s);
@@ -41,12 +45,14 @@ void NFA::getEpsilonClosure(std::set<std::shared_ptr<State>> &currentStates) {
       if (currentStates.find(next) == currentStates.end()) {
         currentStates.insert(next);
         q.push(next);
+        FS_STAT_ADD(closureStates, 1);
       }
     }
   }
 }
 
 bool NFA::simulate(const std::string &input) {
+  FS_STAT_PHASE(Simulate);
   if (!startState)
     return false;
 
@@ -55,11 +61,13 @@ bool NFA::simulate(const std::string &input) {
   getEpsilonClosure(currentStates);
 
   for (char c : input) {
+    FS_STAT_ADD(bytesScanned, 1);
     std::set<std::shared_ptr<State>> nextStates;
     for (const auto &s : currentStates) {
       if (s->transitions.count(c)) {
         for (const auto &next : s->transitions.at(c)) {
           nextStates.insert(next);
+          FS_STAT_ADD(transitions, 1);
         }
       }
     }
@@ -105,41 +113,55 @@ void NFA::printTransitions() const {
 DFA::DFA() : startStateId(-1) {}
 
 bool DFA::simulate(const std::string &input) {
+  return simulate(input.data(), input.size());
+}
+
+bool DFA::simulate(const char *data, size_t length) const {
+  FS_STAT_PHASE(Simulate);
   if (startStateId == -1)
     return false;
 
   int current = startStateId;
-  for (char c : input) {
-    if (states.find(current) == states.end())
-      return false;
-    if (states.at(current).transitions.find(c) ==
-        states.at(current).transitions.end()) {
-      return false;
-    }
-    current = states.at(current).transitions.at(c);
+  size_t i = 0;
+  for (; i < length; ++i) {
+    auto state = states.find(current);
+    if (state == states.end())
+      break;
+    auto next = state->second.transitions.find(data[i]);
+    if (next == state->second.transitions.end())
+      break;
+    current = next->second;
   }
-  return finalStateIds.count(current);
+  FS_STAT_ADD(bytesScanned, i);
+  FS_STAT_ADD(transitions, i);
+  return i == length && finalStateIds.count(current);
 }
 
 std::vector<int> DFA::getTrace(const std::string &input) {
   std::vector<int> trace;
+  getTrace(input.data(), input.size(), trace);
+  return trace;
+}
+
+void DFA::getTrace(const char *data, size_t length,
+                   std::vector<int> &trace) const {
+  trace.clear();
   if (startStateId == -1)
-    return trace;
+    return;
 
   int current = startStateId;
   trace.push_back(current);
 
-  for (char c : input) {
-    if (states.find(current) == states.end())
+  for (size_t i = 0; i < length; ++i) {
+    auto state = states.find(current);
+    if (state == states.end())
       break;
-    if (states.at(current).transitions.find(c) ==
-        states.at(current).transitions.end()) {
+    auto next = state->second.transitions.find(data[i]);
+    if (next == state->second.transitions.end())
       break;
-    }
-    current = states.at(current).transitions.at(c);
+    current = next->second;
     trace.push_back(current);
   }
-  return trace;
 }
 
 void DFA::printTransitions() const {
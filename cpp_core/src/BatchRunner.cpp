@@ -0,0 +1,219 @@
+#include "BatchRunner.h"
+#include "Matcher.h"
+#include "RegexEngine.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace FormalSystem {
+
+void BatchRunner::addRule(const std::string &line) {
+  std::stringstream ss(line);
+  std::string kind, pattern;
+  ss >> kind;
+  if (kind.empty() || kind[0] == '#')
+    return;
+  ss >> pattern;
+  if (pattern.empty())
+    throw std::runtime_error("Missing pattern after '" + kind + "'");
+
+  Rule rule;
+  rule.pattern = pattern;
+  if (kind == "regex") {
+    rule.kind = Whole;
+    rule.dfa = std::make_unique<DenseDFA>(
+        RegexEngine::nfaToDFA(RegexEngine::regexToNFA(pattern)));
+  } else if (kind == "approx") {
+    if (!(ss >> rule.maxErrors) || rule.maxErrors < 0)
+      throw std::runtime_error("Usage: approx <pattern> <k>");
+    // Same literal/regex split as the REPL's approx command
+    if (pattern.find_first_of("|*(){[\\") == std::string::npos) {
+      rule.kind = Literal;
+    } else {
+      rule.kind = Regex;
+      rule.approx = std::make_unique<ApproximateRegex>(pattern, rule.maxErrors);
+    }
+  } else {
+    throw std::runtime_error("Unknown rule '" + kind +
+                             "' (expected regex or approx)");
+  }
+  rules.push_back(std::move(rule));
+}
+
+void BatchRunner::loadRules(const std::string &path) {
+  std::ifstream file(path);
+  if (!file)
+    throw std::runtime_error("Cannot open rules file " + path);
+  std::string line;
+  for (int number = 1; std::getline(file, line); ++number) {
+    try {
+      addRule(line);
+    } catch (const std::exception &e) {
+      throw std::runtime_error(path + ":" + std::to_string(number) + ": " +
+                               e.what());
+    }
+  }
+}
+
+bool BatchRunner::matches(size_t rule, const char *line,
+                          size_t length) const {
+  const Rule &r = rules.at(rule);
+  switch (r.kind) {
+  case Whole:
+    return r.dfa->simulate(line, length);
+  case Literal:
+    return Matcher::approximateMatch(line, length, r.pattern, r.maxErrors);
+  default:
+    return r.approx->search(line, length);
+  }
+}
+
+void BatchRunner::processBlock(const std::string &input, std::string &output,
+                               bool filter) const {
+  output.clear();
+  output.reserve(filter ? input.size() : input.size() / 4);
+  size_t start = 0;
+  while (start < input.size()) {
+    size_t end = input.find('\n', start);
+    if (end == std::string::npos)
+      end = input.size();
+    const char *line = input.data() + start;
+    size_t length = end - start;
+    if (length > 0 && line[length - 1] == '\r')
+      length--;
+    if (filter) {
+      for (size_t i = 0; i < rules.size(); ++i) {
+        if (matches(i, line, length)) {
+          output.append(line, length);
+          output += '\n';
+          break;
+        }
+      }
+    } else {
+      for (size_t i = 0; i < rules.size(); ++i)
+        output += matches(i, line, length) ? '1' : '0';
+      output += '\n';
+    }
+    start = end + 1;
+  }
+}
+
+// The calling thread reads blocks and writes finished ones in order; workers
+// match them. At most 2 blocks per worker are in flight, which bounds memory
+// to about 4 * threads * blockSize (input and output of each block).
+uint64_t BatchRunner::run(std::FILE *in, std::FILE *out,
+                          const Options &options) const {
+  unsigned threads = options.threads;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t window = 2 * threads;
+  const size_t blockSize = std::max<size_t>(options.blockSize, 1);
+
+  struct Block {
+    std::string input;
+    std::string output;
+    uint64_t lines = 0;
+    bool done = false;
+  };
+  std::mutex mutex;
+  std::condition_variable ready;    // New block to match, or shutdown
+  std::condition_variable finished; // A block was matched
+  std::deque<std::unique_ptr<Block>> pending; // Input order, for the writer
+  std::deque<Block *> todo;
+  bool closing = false;
+
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&] {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+        ready.wait(lock, [&] { return closing || !todo.empty(); });
+        if (todo.empty())
+          return;
+        Block *block = todo.front();
+        todo.pop_front();
+        lock.unlock();
+        processBlock(block->input, block->output, options.filter);
+        block->lines = std::count(block->input.begin(), block->input.end(),
+                                  '\n') +
+                       (block->input.back() != '\n');
+        block->input = std::string(); // Release early
+        lock.lock();
+        block->done = true;
+        finished.notify_one();
+      }
+    });
+  }
+
+  // Writes finished blocks from the front; waits while more than `keep`
+  // blocks are pending
+  uint64_t lines = 0;
+  auto drain = [&](size_t keep) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!pending.empty()) {
+      if (!pending.front()->done) {
+        if (pending.size() <= keep)
+          break;
+        finished.wait(lock, [&] { return pending.front()->done; });
+      }
+      std::unique_ptr<Block> block = std::move(pending.front());
+      pending.pop_front();
+      lock.unlock();
+      std::fwrite(block->output.data(), 1, block->output.size(), out);
+      lines += block->lines;
+      lock.lock();
+    }
+  };
+
+  std::string carry;
+  bool eof = false;
+  while (!eof) {
+    auto block = std::make_unique<Block>();
+    std::string &data = block->input;
+    data.swap(carry);
+    size_t kept = data.size();
+    data.resize(kept + blockSize);
+    size_t got = std::fread(&data[kept], 1, blockSize, in);
+    data.resize(kept + got);
+    eof = got < blockSize;
+    if (!eof) {
+      // Cut after the last newline; a line longer than the block keeps
+      // growing the carry until its end is read
+      size_t cut = data.rfind('\n');
+      if (cut == std::string::npos) {
+        carry.swap(data);
+        continue;
+      }
+      carry.assign(data, cut + 1, std::string::npos);
+      data.resize(cut + 1);
+    }
+    if (data.empty())
+      continue;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      todo.push_back(block.get());
+      pending.push_back(std::move(block));
+    }
+    ready.notify_one();
+    drain(window - 1);
+  }
+  drain(0);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closing = true;
+  }
+  ready.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+  std::fflush(out);
+  return lines;
+}
+
+} // namespace FormalSystem
@@ -0,0 +1,213 @@
+#include "CaptureNFA.h"
+#include <utility>
+
+namespace FormalSystem {
+
+CaptureNFA::CaptureNFA() : start(-1), groupCount(1), onePass(false) {}
+
+// ====================== One-Pass DFA ======================
+
+// Follows epsilon edges from 'from' and fills the table row of 'state'.
+// Returns false when two paths compete for the same symbol (or for the final
+// match), i.e. the program is not one-pass.
+bool CaptureNFA::walkOnePass(int state, int from) {
+  std::vector<bool> visited(nodes.size(), false);
+  std::vector<std::pair<int, std::vector<int>>> stack;
+  stack.push_back({from, {}});
+
+  while (!stack.empty()) {
+    auto [id, actions] = stack.back();
+    stack.pop_back();
+    if (id < 0)
+      continue;
+    if (visited[id])
+      return false; // Two epsilon paths converge: ambiguous
+    visited[id] = true;
+
+    const Node &n = nodes[id];
+    if (n.kind == Node::Split) {
+      stack.push_back({n.out1, actions});
+      stack.push_back({n.out, actions});
+    } else if (n.kind == Node::Save) {
+      actions.push_back(n.slot);
+      stack.push_back({n.out, actions});
+    } else if (n.kind == Node::Char) {
+      OnePassEntry &entry =
+          onePassTable[state][static_cast<unsigned char>(n.symbol)];
+      if (entry.next != -1)
+        return false;
+      entry.next = onePassStateOf[n.out];
+      entry.actions = onePassActions.size();
+      onePassActions.push_back(actions);
+    } else if (n.kind == Node::Match) {
+      if (onePassMatchActions[state] != -1)
+        return false;
+      onePassMatchActions[state] = onePassActions.size();
+      onePassActions.push_back(actions);
+    }
+  }
+  return true;
+}
+
+void CaptureNFA::buildOnePass() {
+  onePass = false;
+  onePassStateOf.assign(nodes.size(), -1);
+  onePassTable.clear();
+  onePassMatchActions.clear();
+  onePassActions.clear();
+  if (start == -1)
+    return;
+
+  // One-pass states: the start node and every node entered after a symbol
+  std::vector<int> stateNodes = {start};
+  onePassStateOf[start] = 0;
+  for (const auto &n : nodes) {
+    if (n.kind == Node::Char && onePassStateOf[n.out] == -1) {
+      onePassStateOf[n.out] = stateNodes.size();
+      stateNodes.push_back(n.out);
+    }
+  }
+  if (static_cast<int>(stateNodes.size()) > MAX_ONEPASS_STATES)
+    return;
+
+  onePassTable.assign(stateNodes.size(), {});
+  onePassMatchActions.assign(stateNodes.size(), -1);
+  for (size_t state = 0; state < stateNodes.size(); ++state) {
+    if (!walkOnePass(state, stateNodes[state])) {
+      onePassTable.clear();
+      onePassMatchActions.clear();
+      onePassActions.clear();
+      return;
+    }
+  }
+  onePass = true;
+}
+
+bool CaptureNFA::onePassMatch(const std::string &input,
+                              std::vector<int> &captures) const {
+  captures.assign(2 * groupCount, -1);
+  if (!onePass)
+    return false;
+
+  int state = 0;
+  for (size_t i = 0; i < input.size(); ++i) {
+    const OnePassEntry &entry =
+        onePassTable[state][static_cast<unsigned char>(input[i])];
+    if (entry.next == -1)
+      return false;
+    for (int slot : onePassActions[entry.actions])
+      captures[slot] = i;
+    state = entry.next;
+  }
+
+  int accept = onePassMatchActions[state];
+  if (accept == -1)
+    return false;
+  for (int slot : onePassActions[accept])
+    captures[slot] = input.size();
+  return true;
+}
+
+// ====================== Pike VM ======================
+
+bool CaptureNFA::pikeMatch(const std::string &input,
+                           std::vector<int> &captures) const {
+  struct Thread {
+    int node;
+    std::vector<int> caps;
+  };
+
+  captures.assign(2 * groupCount, -1);
+  if (start == -1)
+    return false;
+
+  std::vector<Thread> current, next;
+  std::vector<int> mark(nodes.size(), -1);
+  std::vector<std::pair<int, std::vector<int>>> stack;
+
+  // Adds a thread and everything reachable by epsilon, in priority order
+  auto addThread = [&](std::vector<Thread> &list, int node,
+                       const std::vector<int> &caps, int pos) {
+    stack.push_back({node, caps});
+    while (!stack.empty()) {
+      auto [id, c] = std::move(stack.back());
+      stack.pop_back();
+      if (id < 0 || mark[id] == pos)
+        continue;
+      mark[id] = pos;
+
+      const Node &n = nodes[id];
+      if (n.kind == Node::Split) {
+        stack.push_back({n.out1, c});
+        stack.push_back({n.out, std::move(c)});
+      } else if (n.kind == Node::Save) {
+        c[n.slot] = pos;
+        stack.push_back({n.out, std::move(c)});
+      } else {
+        list.push_back({id, std::move(c)});
+      }
+    }
+  };
+
+  addThread(current, start, captures, 0);
+
+  for (size_t i = 0; i < input.size() && !current.empty(); ++i) {
+    next.clear();
+    for (const auto &t : current) {
+      const Node &n = nodes[t.node];
+      if (n.kind == Node::Char && n.symbol == input[i])
+        addThread(next, n.out, t.caps, i + 1);
+    }
+    std::swap(current, next);
+  }
+
+  if (current.empty())
+    return false;
+  for (const auto &t : current) {
+    if (nodes[t.node].kind == Node::Match) {
+      captures = t.caps;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CaptureNFA::match(const std::string &input,
+                       std::vector<int> &captures) const {
+  return onePass ? onePassMatch(input, captures) : pikeMatch(input, captures);
+}
+
+bool CaptureNFA::simulate(const std::string &input) {
+  std::vector<int> captures;
+  return match(input, captures);
+}
+
+void CaptureNFA::printTransitions() const {
+  std::cout << "\n=== Capture NFA Program ===\n";
+  for (size_t id = 0; id < nodes.size(); ++id) {
+    const Node &n = nodes[id];
+    switch (n.kind) {
+    case Node::Char:
+      std::cout << "  Node " << id << " --" << n.symbol << "--> Node " << n.out
+                << "\n";
+      break;
+    case Node::Split:
+      std::cout << "  Node " << id << " --(eps)--> Node " << n.out << "\n";
+      if (n.out1 != -1)
+        std::cout << "  Node " << id << " --(eps)--> Node " << n.out1 << "\n";
+      break;
+    case Node::Save:
+      std::cout << "  Node " << id << " --(save " << n.slot << ")--> Node "
+                << n.out << "\n";
+      break;
+    case Node::Match:
+      break;
+    }
+  }
+  std::cout << "Start Node: " << start << "\n";
+  std::cout << "Groups: " << groupCount - 1
+            << (onePass ? " (one-pass)" : " (Pike VM)") << "\n";
+  std::cout << "===========================\n";
+}
+
+} // namespace FormalSystem
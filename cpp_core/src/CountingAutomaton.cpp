@@ -0,0 +1,146 @@
+#include "CountingAutomaton.h"
+#include <algorithm>
+#include <iterator>
+
+namespace FormalSystem {
+
+// Nodes outside every counter scope carry the single marker value 0
+static const std::vector<int> PRESENT = {0};
+
+CountingNFA::CountingNFA() : start(-1) {}
+
+bool CountingNFA::addToSet(std::vector<CountingSet> &sets,
+                           std::vector<int> &active, int node,
+                           const CountingSet &values) {
+  if (node < 0 || values.empty())
+    return false;
+
+  CountingSet &target = sets[node];
+  if (target.empty()) {
+    target = values;
+    active.push_back(node);
+    return true;
+  }
+
+  CountingSet merged;
+  std::set_union(target.begin(), target.end(), values.begin(), values.end(),
+                 std::back_inserter(merged));
+  if (merged.size() == target.size())
+    return false;
+  target.swap(merged);
+  return true;
+}
+
+void CountingNFA::closure(std::vector<CountingSet> &sets,
+                          std::vector<int> &active) {
+  std::vector<int> worklist = active;
+  auto propagate = [&](int to, const CountingSet &values) {
+    if (addToSet(sets, active, to, values))
+      worklist.push_back(to);
+  };
+
+  while (!worklist.empty()) {
+    int id = worklist.back();
+    worklist.pop_back();
+    const Node &n = nodes[id];
+    CountingSet values = sets[id];
+
+    if (n.kind == Node::Split) {
+      propagate(n.out, values);
+      propagate(n.out1, values);
+    } else if (n.kind == Node::Enter) {
+      propagate(n.out, {1});
+    } else if (n.kind == Node::Loop) {
+      const Counter &c = counters[n.counter];
+
+      // Leave the body once the current iteration reaches the lower bound
+      if (values.back() >= c.min)
+        propagate(n.out1, PRESENT);
+
+      // Start another iteration; unbounded counters saturate at min
+      CountingSet next;
+      for (int v : values) {
+        if (c.max != -1 && v >= c.max)
+          break;
+        int bumped = c.max == -1 ? std::min(v + 1, c.min) : v + 1;
+        if (next.empty() || next.back() != bumped)
+          next.push_back(bumped);
+      }
+      propagate(n.out, next);
+    }
+  }
+}
+
+bool CountingNFA::simulate(const std::string &input) {
+  if (start == -1)
+    return false;
+
+  std::vector<CountingSet> current(nodes.size()), next(nodes.size());
+  std::vector<int> currentActive, nextActive;
+
+  addToSet(current, currentActive, start, PRESENT);
+  closure(current, currentActive);
+
+  for (char c : input) {
+    for (int id : currentActive) {
+      const Node &n = nodes[id];
+      if (n.kind == Node::Char && n.symbol == c)
+        addToSet(next, nextActive, n.out, current[id]);
+    }
+
+    for (int id : currentActive)
+      current[id].clear();
+    currentActive.clear();
+
+    if (nextActive.empty())
+      return false;
+
+    closure(next, nextActive);
+    std::swap(current, next);
+    std::swap(currentActive, nextActive);
+  }
+
+  for (int id : currentActive) {
+    if (nodes[id].kind == Node::Match)
+      return true;
+  }
+  return false;
+}
+
+void CountingNFA::printTransitions() const {
+  std::cout << "\n=== Counting NFA Transitions ===\n";
+  for (size_t id = 0; id < nodes.size(); ++id) {
+    const Node &n = nodes[id];
+    switch (n.kind) {
+    case Node::Char:
+      std::cout << "  Node " << id << " --" << n.symbol << "--> Node " << n.out
+                << "\n";
+      break;
+    case Node::Split:
+      std::cout << "  Node " << id << " --(eps)--> Node " << n.out << "\n";
+      if (n.out1 != -1)
+        std::cout << "  Node " << id << " --(eps)--> Node " << n.out1 << "\n";
+      break;
+    case Node::Enter:
+      std::cout << "  Node " << id << " --(c" << n.counter
+                << " := 1)--> Node " << n.out << "\n";
+      break;
+    case Node::Loop: {
+      const Counter &c = counters[n.counter];
+      std::cout << "  Node " << id << " --(c" << n.counter << " < "
+                << (c.max == -1 ? "inf" : std::to_string(c.max)) << ": c"
+                << n.counter << "++)--> Node " << n.out << "\n";
+      std::cout << "  Node " << id << " --(c" << n.counter << " >= " << c.min
+                << ")--> Node " << n.out1 << "\n";
+      break;
+    }
+    case Node::Match:
+      break;
+    }
+  }
+  std::cout << "Start Node: " << start << "\n";
+  std::cout << "Counters: " << counters.size() << "\n";
+  std::cout << "================================\n";
+}
+
+} // namespace FormalSystem
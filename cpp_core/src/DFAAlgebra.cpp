@@ -0,0 +1,296 @@
+#include "DFAAlgebra.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace FormalSystem {
+
+namespace {
+
+constexpr int32_t DEAD = DenseDFA::DEAD;
+
+// Open-addressing map from a packed (a, b) state pair to its product state.
+// Key 0 is the empty slot; it would be (DEAD, DEAD), which is never stored.
+class PairIndex {
+public:
+  PairIndex() : keys(1 << 10, 0), ids(1 << 10), used(0) {}
+
+  static uint64_t key(int32_t p, int32_t q) {
+    return static_cast<uint64_t>(p + 1) << 32 | static_cast<uint32_t>(q + 1);
+  }
+
+  // Returns the ID stored for key, or stores and returns id
+  int32_t findOrInsert(uint64_t key, int32_t id, bool &inserted) {
+    if ((used + 1) * 2 > keys.size())
+      grow();
+    size_t slot = probe(key);
+    inserted = keys[slot] == 0;
+    if (inserted) {
+      keys[slot] = key;
+      ids[slot] = id;
+      used++;
+    }
+    return ids[slot];
+  }
+
+private:
+  std::vector<uint64_t> keys;
+  std::vector<int32_t> ids;
+  size_t used;
+
+  size_t probe(uint64_t key) const {
+    size_t mask = keys.size() - 1;
+    uint64_t h = key * 0x9E3779B97F4A7C15ull;
+    size_t slot = (h ^ h >> 29) & mask;
+    while (keys[slot] != 0 && keys[slot] != key)
+      slot = (slot + 1) & mask;
+    return slot;
+  }
+
+  void grow() {
+    std::vector<uint64_t> oldKeys = std::move(keys);
+    std::vector<int32_t> oldIds = std::move(ids);
+    keys.assign(oldKeys.size() * 2, 0);
+    ids.assign(oldIds.size() * 2, 0);
+    for (size_t i = 0; i < oldKeys.size(); ++i) {
+      if (oldKeys[i] == 0)
+        continue;
+      size_t slot = probe(oldKeys[i]);
+      keys[slot] = oldKeys[i];
+      ids[slot] = oldIds[i];
+    }
+  }
+};
+
+std::vector<unsigned char> representatives(const std::array<uint8_t, 256> &c,
+                                           int count) {
+  std::vector<unsigned char> reps(count);
+  for (int b = 255; b >= 0; --b)
+    reps[c[b]] = b;
+  return reps;
+}
+
+// Transition that treats DEAD as a sink
+int32_t step(const DenseDFA &dfa, int32_t state, unsigned char c) {
+  return state == DEAD ? DEAD : dfa.next(state, c);
+}
+
+bool accepts(const DenseDFA &dfa, int32_t state) {
+  return state != DEAD && dfa.accepting[state];
+}
+
+} // namespace
+
+int DFAAlgebra::refineClasses(const DenseDFA &a, const DenseDFA &b,
+                              std::array<uint8_t, 256> &classes) {
+  std::vector<int> ids(static_cast<size_t>(a.classCount) * b.classCount, -1);
+  int count = 0;
+  for (int c = 0; c < 256; ++c) {
+    int &id = ids[a.byteClass[c] * b.classCount + b.byteClass[c]];
+    if (id == -1)
+      id = count++;
+    classes[c] = id;
+  }
+  return count;
+}
+
+// ====================== Product ======================
+
+DenseDFA DFAAlgebra::product(const DenseDFA &a, const DenseDFA &b,
+                             Operation op, size_t maxStates) {
+  std::array<uint8_t, 256> classes;
+  int count = refineClasses(a, b, classes);
+  std::vector<unsigned char> reps = representatives(classes, count);
+  DenseDFA result;
+  result.setClasses(classes, count);
+
+  // A pair is kept only while op can still accept something from it
+  auto alive = [op](int32_t p, int32_t q) {
+    switch (op) {
+    case Intersection:
+      return p != DEAD && q != DEAD;
+    case Difference:
+      return p != DEAD;
+    default:
+      return p != DEAD || q != DEAD;
+    }
+  };
+  auto accepting = [&](int32_t p, int32_t q) {
+    bool inA = accepts(a, p), inB = accepts(b, q);
+    switch (op) {
+    case Intersection:
+      return inA && inB;
+    case Union:
+      return inA || inB;
+    case Difference:
+      return inA && !inB;
+    default:
+      return inA != inB;
+    }
+  };
+
+  PairIndex index;
+  std::vector<std::pair<int32_t, int32_t>> pairs; // Product state -> pair
+  auto intern = [&](int32_t p, int32_t q) {
+    bool inserted;
+    int32_t id = index.findOrInsert(PairIndex::key(p, q), pairs.size(),
+                                    inserted);
+    if (inserted) {
+      if (maxStates > 0 && pairs.size() >= maxStates)
+        throw std::runtime_error("Product automaton exceeds " +
+                                 std::to_string(maxStates) + " states");
+      pairs.push_back({p, q});
+      result.addState(accepting(p, q));
+    }
+    return id;
+  };
+
+  if (!alive(a.start, b.start))
+    return result;
+  result.start = intern(a.start, b.start);
+
+  // States are numbered in BFS order, so the pair list is the worklist
+  for (size_t s = 0; s < pairs.size(); ++s) {
+    auto [p, q] = pairs[s];
+    for (int c = 0; c < count; ++c) {
+      int32_t np = step(a, p, reps[c]), nq = step(b, q, reps[c]);
+      if (!alive(np, nq))
+        continue;
+      int32_t target = intern(np, nq); // May grow the table
+      result.at(s, c) = target;
+    }
+  }
+  result.compressClasses();
+  return result;
+}
+
+// ====================== Complement ======================
+
+DenseDFA DFAAlgebra::complement(const DenseDFA &a,
+                                const std::string &alphabet) {
+  bool inAlphabet[256] = {};
+  for (char c : alphabet)
+    inAlphabet[static_cast<unsigned char>(c)] = true;
+
+  // Split a's classes by alphabet membership
+  std::array<uint8_t, 256> classes;
+  std::vector<int> ids(static_cast<size_t>(a.classCount) * 2, -1);
+  int count = 0;
+  for (int c = 0; c < 256; ++c) {
+    int &id = ids[a.byteClass[c] * 2 + inAlphabet[c]];
+    if (id == -1)
+      id = count++;
+    classes[c] = id;
+  }
+  std::vector<unsigned char> reps = representatives(classes, count);
+
+  DenseDFA result;
+  result.setClasses(classes, count);
+  for (int32_t s = 0; s < a.stateCount(); ++s)
+    result.addState(!a.accepting[s]);
+  int32_t sink = result.addState(true); // Stands in for a's DEAD
+  for (int32_t s = 0; s <= sink; ++s) {
+    for (int c = 0; c < count; ++c) {
+      if (!inAlphabet[reps[c]])
+        continue;
+      int32_t t = s == sink ? DEAD : a.next(s, reps[c]);
+      result.at(s, c) = t == DEAD ? sink : t;
+    }
+  }
+  result.start = a.start == DEAD ? sink : a.start;
+  result.compressClasses();
+  return result;
+}
+
+// ====================== Equivalence ======================
+
+bool DFAAlgebra::equivalent(const DenseDFA &a, const DenseDFA &b,
+                            std::string *counterexample) {
+  std::array<uint8_t, 256> classes;
+  int count = refineClasses(a, b, classes);
+  std::vector<unsigned char> reps = representatives(classes, count);
+
+  // Union-find nodes: a's states, a's DEAD, b's states, b's DEAD
+  int32_t na = a.stateCount(), nb = b.stateCount();
+  auto nodeA = [&](int32_t p) { return p == DEAD ? na : p; };
+  auto nodeB = [&](int32_t q) { return na + 1 + (q == DEAD ? nb : q); };
+  std::vector<int32_t> parent(na + nb + 2), size(na + nb + 2, 1);
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&](int32_t x) {
+    while (parent[x] != x) {
+      parent[x] = parent[parent[x]];
+      x = parent[x];
+    }
+    return x;
+  };
+  auto unite = [&](int32_t x, int32_t y) {
+    x = find(x);
+    y = find(y);
+    if (x == y)
+      return false;
+    if (size[x] < size[y])
+      std::swap(x, y);
+    parent[y] = x;
+    size[x] += size[y];
+    return true;
+  };
+
+  // BFS worklist of merged pairs, linked back for the counterexample
+  struct Pair {
+    int32_t p, q;
+    int32_t from;
+    unsigned char symbol;
+  };
+  std::vector<Pair> pairs{{a.start, b.start, -1, 0}};
+  unite(nodeA(a.start), nodeB(b.start));
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    Pair pair = pairs[i];
+    if (accepts(a, pair.p) != accepts(b, pair.q)) {
+      if (counterexample) {
+        counterexample->clear();
+        for (int32_t j = i; pairs[j].from != -1; j = pairs[j].from)
+          counterexample->push_back(pairs[j].symbol);
+        std::reverse(counterexample->begin(), counterexample->end());
+      }
+      return false;
+    }
+    for (int c = 0; c < count; ++c) {
+      int32_t np = step(a, pair.p, reps[c]), nq = step(b, pair.q, reps[c]);
+      if (unite(nodeA(np), nodeB(nq)))
+        pairs.push_back({np, nq, static_cast<int32_t>(i), reps[c]});
+    }
+  }
+  return true;
+}
+
+bool DFAAlgebra::shortestAccepted(const DenseDFA &a, std::string &witness) {
+  witness.clear();
+  if (a.start == DEAD)
+    return false;
+  std::vector<unsigned char> reps = a.classRepresentatives();
+  std::vector<int32_t> from(a.stateCount(), -2);
+  std::vector<unsigned char> symbol(a.stateCount());
+  std::vector<int32_t> queue{a.start};
+  from[a.start] = -1;
+  for (size_t i = 0; i < queue.size(); ++i) {
+    int32_t s = queue[i];
+    if (a.accepting[s]) {
+      for (; from[s] != -1; s = from[s])
+        witness.push_back(symbol[s]);
+      std::reverse(witness.begin(), witness.end());
+      return true;
+    }
+    for (unsigned char c : reps) {
+      int32_t t = a.next(s, c);
+      if (t == DEAD || from[t] != -2)
+        continue;
+      from[t] = s;
+      symbol[t] = c;
+      queue.push_back(t);
+    }
+  }
+  return false;
+}
+
+} // namespace FormalSystem
@@ -0,0 +1,183 @@
+#include "DFAJit.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if FS_JIT_SUPPORTED
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace FormalSystem {
+
+JitDFA::JitDFA(const DFA &dfa) : JitDFA(DenseDFA(dfa)) {}
+
+JitDFA::JitDFA(const DenseDFA &dense)
+    : fallback(dense), code(nullptr), size(0), entry(nullptr) {
+  compile();
+}
+
+JitDFA::~JitDFA() {
+#if FS_JIT_SUPPORTED
+  if (code)
+    munmap(code, size);
+#endif
+}
+
+bool JitDFA::simulate(const std::string &input) const {
+  return simulate(input.data(), input.size());
+}
+
+bool JitDFA::simulate(const char *data, size_t length) const {
+  if (!entry)
+    return fallback.simulate(data, length);
+  auto p = reinterpret_cast<const unsigned char *>(data);
+  return entry(p, p + length) != 0;
+}
+
+#if FS_JIT_SUPPORTED
+
+namespace {
+
+// Minimal x86-64 emitter with rel32 fixups against labels
+struct Emitter {
+  std::vector<uint8_t> buf;
+  std::vector<std::pair<size_t, int>> fixups; // rel32 position -> label
+
+  void bytes(std::initializer_list<uint8_t> b) {
+    buf.insert(buf.end(), b.begin(), b.end());
+  }
+  void imm32(int32_t v) {
+    uint8_t b[4];
+    std::memcpy(b, &v, 4);
+    buf.insert(buf.end(), b, b + 4);
+  }
+  void rel32(int label) {
+    fixups.push_back({buf.size(), label});
+    imm32(0);
+  }
+  void patch32(size_t pos, int32_t v) { std::memcpy(&buf[pos], &v, 4); }
+};
+
+struct ByteRange {
+  int lo;
+  int hi;
+  int32_t target;
+};
+
+} // namespace
+
+// Generated function: int match(const uint8_t *p, const uint8_t *end)
+// rdi = p, rsi = end, result in eax. Labels 0..n-1 are states, n is reject.
+void JitDFA::compile() {
+  int n = fallback.stateCount();
+  if (n == 0)
+    return;
+  const int reject = n;
+
+  Emitter e;
+  std::vector<size_t> labels(n + 1);
+  std::vector<std::pair<size_t, int>> tableRefs; // lea disp32 -> state
+
+  for (int s = 0; s < n; ++s) {
+    labels[s] = e.buf.size();
+
+    e.bytes({0x48, 0x39, 0xF7});                  // cmp rdi, rsi
+    e.bytes({0x72, 0x06});                        // jb body
+    e.bytes({0xB8});                              // mov eax, accepting
+    e.imm32(fallback.accepting[s]);
+    e.bytes({0xC3});                              // ret
+    e.bytes({0x0F, 0xB6, 0x07});                  // body: movzx eax, [rdi]
+    e.bytes({0x48, 0xFF, 0xC7});                  // inc rdi
+
+    std::vector<ByteRange> ranges;
+    for (int c = 0; c < 256; ++c) {
+      int32_t t = fallback.next(s, c);
+      if (t == DenseDFA::DEAD)
+        continue;
+      if (!ranges.empty() && ranges.back().hi == c - 1 &&
+          ranges.back().target == t)
+        ranges.back().hi = c;
+      else
+        ranges.push_back({c, c, t});
+    }
+
+    if (static_cast<int>(ranges.size()) <= MAX_COMPARE_RANGES) {
+      for (const auto &r : ranges) {
+        if (r.lo == r.hi) {
+          e.bytes({0x3D});                        // cmp eax, lo
+          e.imm32(r.lo);
+          e.bytes({0x0F, 0x84});                  // je target
+        } else {
+          e.bytes({0x8D, 0x88});                  // lea ecx, [rax - lo]
+          e.imm32(-r.lo);
+          e.bytes({0x81, 0xF9});                  // cmp ecx, hi - lo
+          e.imm32(r.hi - r.lo);
+          e.bytes({0x0F, 0x86});                  // jbe target
+        }
+        e.rel32(r.target);
+      }
+      e.bytes({0xE9});                            // jmp reject
+      e.rel32(reject);
+    } else {
+      e.bytes({0x48, 0x8D, 0x0D});                // lea rcx, [rip + table]
+      tableRefs.push_back({e.buf.size(), s});
+      e.imm32(0);
+      e.bytes({0xFF, 0x24, 0xC1});                // jmp [rcx + rax * 8]
+    }
+  }
+
+  labels[reject] = e.buf.size();
+  e.bytes({0x31, 0xC0, 0xC3});                    // xor eax, eax; ret
+
+  for (const auto &[pos, label] : e.fixups)
+    e.patch32(pos, static_cast<int32_t>(labels[label] - (pos + 4)));
+
+  // Jump tables (absolute addresses, filled in once the base is known)
+  while (e.buf.size() % 8)
+    e.bytes({0xCC});
+  std::vector<size_t> tableOffsets;
+  for (const auto &[pos, s] : tableRefs) {
+    tableOffsets.push_back(e.buf.size());
+    e.patch32(pos, static_cast<int32_t>(e.buf.size() - (pos + 4)));
+    e.buf.resize(e.buf.size() + 256 * 8);
+  }
+
+  if (e.buf.size() > MAX_CODE_SIZE)
+    return;
+
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t mapped = (e.buf.size() + page - 1) / page * page;
+  void *mem = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED)
+    return;
+
+  auto base = reinterpret_cast<uintptr_t>(mem);
+  for (size_t i = 0; i < tableRefs.size(); ++i) {
+    int s = tableRefs[i].second;
+    for (int c = 0; c < 256; ++c) {
+      int32_t t = fallback.next(s, c);
+      uint64_t addr = base + labels[t == DenseDFA::DEAD ? reject : t];
+      std::memcpy(&e.buf[tableOffsets[i] + c * 8], &addr, 8);
+    }
+  }
+
+  std::memcpy(mem, e.buf.data(), e.buf.size());
+  if (mprotect(mem, mapped, PROT_READ | PROT_EXEC) != 0) {
+    munmap(mem, mapped);
+    return;
+  }
+
+  code = mem;
+  size = mapped;
+  entry = reinterpret_cast<MatchFn>(mem);
+}
+
+#else
+
+void JitDFA::compile() {} // No JIT on this platform; use the interpreter
+
+#endif
+
+} // namespace FormalSystem
@@ -0,0 +1,172 @@
+#include "DenseDFA.h"
+#include "Stats.h"
+#include <unordered_map>
+
+namespace FormalSystem {
+
+DenseDFA::DenseDFA() : classCount(1), shift(0), start(DEAD) {
+  byteClass.fill(0);
+}
+
+void DenseDFA::setClasses(const std::array<uint8_t, 256> &classes,
+                          int count) {
+  byteClass = classes;
+  classCount = count;
+  shift = 0;
+  while ((1 << shift) < count)
+    shift++;
+  table.clear();
+  accepting.clear();
+  originalIds.clear();
+  start = DEAD;
+}
+
+int32_t DenseDFA::addState(bool isAccepting) {
+  accepting.push_back(isAccepting ? 1 : 0);
+  table.resize(accepting.size() << shift, DEAD);
+  return accepting.size() - 1;
+}
+
+DenseDFA::DenseDFA(const DFA &dfa) : DenseDFA() {
+  if (dfa.startStateId == -1 || !dfa.states.count(dfa.startStateId))
+    return;
+
+  // One class per byte, merged below
+  std::array<uint8_t, 256> identity;
+  for (int c = 0; c < 256; ++c)
+    identity[c] = c;
+  setClasses(identity, 256);
+
+  // Start state first, then the remaining states in ID order
+  std::unordered_map<int, int32_t> dense;
+  originalIds.push_back(dfa.startStateId);
+  dense[dfa.startStateId] = 0;
+  for (const auto &[id, state] : dfa.states) {
+    if (id != dfa.startStateId) {
+      dense[id] = originalIds.size();
+      originalIds.push_back(id);
+    }
+  }
+
+  for (size_t s = 0; s < originalIds.size(); ++s) {
+    const auto &state = dfa.states.at(originalIds[s]);
+    addState(dfa.finalStateIds.count(state.id));
+    for (const auto &[symbol, nextId] : state.transitions) {
+      auto it = dense.find(nextId);
+      if (it != dense.end())
+        at(s, static_cast<unsigned char>(symbol)) = it->second;
+    }
+  }
+  start = 0;
+  compressClasses();
+}
+
+std::vector<unsigned char> DenseDFA::classRepresentatives() const {
+  std::vector<unsigned char> reps(classCount);
+  for (int c = 255; c >= 0; --c)
+    reps[byteClass[c]] = c;
+  return reps;
+}
+
+void DenseDFA::compressClasses() {
+  size_t n = accepting.size();
+  int k = classCount;
+
+  // Hash each column, then confirm candidates column by column
+  std::vector<uint64_t> hash(k, 1469598103934665603ull);
+  for (size_t s = 0; s < n; ++s) {
+    for (int c = 0; c < k; ++c)
+      hash[c] = (hash[c] ^ static_cast<uint32_t>(at(s, c))) * 1099511628211ull;
+  }
+  auto sameColumn = [&](int a, int b) {
+    for (size_t s = 0; s < n; ++s) {
+      if (at(s, a) != at(s, b))
+        return false;
+    }
+    return true;
+  };
+
+  std::vector<int> merged(k, -1); // Old class -> new class
+  std::vector<int> kept;          // New class -> old representative
+  std::unordered_multimap<uint64_t, int> byHash;
+  for (int c = 0; c < k; ++c) {
+    auto range = byHash.equal_range(hash[c]);
+    for (auto it = range.first; it != range.second && merged[c] == -1; ++it) {
+      if (sameColumn(kept[it->second], c))
+        merged[c] = it->second;
+    }
+    if (merged[c] == -1) {
+      merged[c] = kept.size();
+      byHash.emplace(hash[c], kept.size());
+      kept.push_back(c);
+    }
+  }
+  if (static_cast<int>(kept.size()) == k)
+    return;
+
+  DenseDFA compact;
+  std::array<uint8_t, 256> classes;
+  for (int c = 0; c < 256; ++c)
+    classes[c] = merged[byteClass[c]];
+  compact.setClasses(classes, kept.size());
+  for (size_t s = 0; s < n; ++s) {
+    compact.addState(accepting[s]);
+    for (size_t c = 0; c < kept.size(); ++c)
+      compact.at(s, c) = at(s, kept[c]);
+  }
+  compact.originalIds.swap(originalIds);
+  compact.start = start;
+  *this = std::move(compact);
+}
+
+DFA DenseDFA::toDFA() const {
+  DFA dfa;
+  if (start == DEAD)
+    return dfa;
+  dfa.startStateId = start;
+  for (int32_t s = 0; s < stateCount(); ++s) {
+    auto &state = dfa.states[s];
+    state.id = s;
+    state.isFinal = accepting[s];
+    if (accepting[s])
+      dfa.finalStateIds.insert(s);
+    for (int c = 0; c < 256; ++c) {
+      int32_t t = next(s, c);
+      if (t == DEAD)
+        continue;
+      state.transitions[static_cast<char>(c)] = t;
+      dfa.alphabet.insert(static_cast<char>(c));
+    }
+  }
+  return dfa;
+}
+
+bool DenseDFA::simulate(const std::string &input) const {
+  return simulate(input.data(), input.size());
+}
+
+bool DenseDFA::simulate(const char *data, size_t length) const {
+  FS_STAT_PHASE(Simulate);
+  if (start == DEAD)
+    return false;
+
+  const int32_t *t = table.data();
+  const uint8_t *classes = byteClass.data();
+  const int rowShift = shift;
+  int32_t state = start;
+  for (size_t i = 0; i < length; ++i) {
+    state = t[(static_cast<size_t>(state) << rowShift) +
+              classes[static_cast<unsigned char>(data[i])]];
+    if (state == DEAD) {
+      // Like DFA::simulate: the byte without a transition is not consumed
+      FS_STAT_ADD(bytesScanned, i);
+      FS_STAT_ADD(transitions, i);
+      return false;
+    }
+  }
+  FS_STAT_ADD(bytesScanned, length);
+  FS_STAT_ADD(transitions, length);
+  return accepting[state];
+}
+
+} // namespace FormalSystem
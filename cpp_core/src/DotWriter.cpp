@@ -0,0 +1,340 @@
+#include "DotWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace FormalSystem {
+
+// ====================== Buffered Sink ======================
+
+DotSink::DotSink(Flush flush, size_t capacity)
+    : buffer(std::max<size_t>(capacity, 64)), out(std::move(flush)) {}
+
+DotSink::~DotSink() { flush(); }
+
+void DotSink::write(const char *data, size_t length) {
+  while (length > 0) {
+    if (used == buffer.size())
+      flush();
+    size_t n = std::min(length, buffer.size() - used);
+    std::memcpy(buffer.data() + used, data, n);
+    used += n;
+    data += n;
+    length -= n;
+  }
+}
+
+void DotSink::flush() {
+  if (used > 0)
+    out(buffer.data(), used);
+  used = 0;
+}
+
+DotSink &DotSink::operator<<(const char *text) {
+  write(text, std::strlen(text));
+  return *this;
+}
+
+DotSink &DotSink::operator<<(long long value) {
+  char digits[24];
+  int n = std::snprintf(digits, sizeof(digits), "%lld", value);
+  write(digits, n);
+  return *this;
+}
+
+// ====================== Graph Extraction ======================
+
+// Automaton-independent view: states by index, edges in the automaton's own
+// iteration order so unmerged output matches the classic format exactly
+struct DotWriter::Graph {
+  struct Edge {
+    int to;
+    char symbol;
+    bool epsilon;
+  };
+  std::vector<int> ids;
+  std::vector<int> finals; // Indices, in the automaton's order
+  std::vector<std::vector<Edge>> out;
+  int start = -1;
+};
+
+DotStats DotWriter::write(const DFA &dfa, DotSink &sink,
+                          const DotOptions &options) {
+  Graph g;
+  std::unordered_map<int, int> index;
+  // IDs referenced but missing from the state map still become nodes
+  auto lookup = [&](int id) {
+    auto [it, inserted] = index.emplace(id, g.ids.size());
+    if (inserted) {
+      g.ids.push_back(id);
+      g.out.emplace_back();
+    }
+    return it->second;
+  };
+  for (const auto &[id, state] : dfa.states)
+    lookup(id);
+  for (const auto &[id, state] : dfa.states) {
+    int from = index[id];
+    for (const auto &[symbol, next] : state.transitions) {
+      int to = lookup(next);
+      g.out[from].push_back({to, symbol, false});
+    }
+  }
+  for (int id : dfa.finalStateIds)
+    g.finals.push_back(lookup(id));
+  if (dfa.startStateId != -1)
+    g.start = lookup(dfa.startStateId);
+  return writeGraph(g, "DFA", sink, options);
+}
+
+DotStats DotWriter::write(const NFA &nfa, DotSink &sink,
+                          const DotOptions &options) {
+  Graph g;
+  std::unordered_map<const State *, int> index;
+  for (const auto &state : nfa.allStates) {
+    index[state.get()] = g.ids.size();
+    g.ids.push_back(state->id);
+  }
+  g.out.resize(g.ids.size());
+  for (const auto &state : nfa.allStates) {
+    auto &edges = g.out[index[state.get()]];
+    for (const auto &[symbol, nextStates] : state->transitions) {
+      for (const auto &next : nextStates)
+        edges.push_back({index.at(next.get()), symbol, false});
+    }
+    for (const auto &next : state->epsilonTransitions)
+      edges.push_back({index.at(next.get()), 0, true});
+  }
+  for (const auto &state : nfa.finalStates)
+    g.finals.push_back(index.at(state.get()));
+  if (nfa.startState)
+    g.start = index.at(nfa.startState.get());
+  return writeGraph(g, "NFA", sink, options);
+}
+
+// ====================== Labels ======================
+
+// Bytes outside printable ASCII (UTF-8 lead/continuation bytes, controls)
+// are written as \xHH so the DOT file stays valid text
+static void appendEscaped(std::string &out, char c) {
+  unsigned char byte = static_cast<unsigned char>(c);
+  if (byte < 0x20 || byte >= 0x7F) {
+    static const char hex[] = "0123456789ABCDEF";
+    out += "\\\\x";
+    out += hex[byte >> 4];
+    out += hex[byte & 15];
+    return;
+  }
+  if (c == '"' || c == '\\')
+    out += '\\';
+  out += c;
+}
+
+std::string DotWriter::rangeLabel(std::vector<char> symbols) {
+  std::sort(symbols.begin(), symbols.end(), [](char a, char b) {
+    return static_cast<unsigned char>(a) < static_cast<unsigned char>(b);
+  });
+  symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+  std::string label;
+  for (size_t i = 0; i < symbols.size();) {
+    size_t j = i;
+    while (j + 1 < symbols.size() &&
+           static_cast<unsigned char>(symbols[j + 1]) ==
+               static_cast<unsigned char>(symbols[j]) + 1)
+      j++;
+    if (!label.empty())
+      label += ',';
+    appendEscaped(label, symbols[i]);
+    if (j - i >= 2) {
+      label += '-';
+      appendEscaped(label, symbols[j]);
+    } else if (j == i + 1) {
+      label += ',';
+      appendEscaped(label, symbols[j]);
+    }
+    i = j + 1;
+  }
+  return label;
+}
+
+// ====================== Writer ======================
+
+DotStats DotWriter::writeGraph(const Graph &g, const char *name, DotSink &sink,
+                               const DotOptions &options) {
+  size_t n = g.ids.size();
+  DotStats stats;
+
+  // Selection: everything, or BFS from the start within the budget/depth
+  std::vector<bool> selected(n, true);
+  bool limited = options.maxStates > 0 || options.maxDepth >= 0;
+  if (limited) {
+    std::fill(selected.begin(), selected.end(), false);
+    std::vector<int> depth(n, -1);
+    std::queue<int> queue;
+    size_t budget = options.maxStates > 0 ? options.maxStates : n;
+    if (g.start != -1 && budget > 0) {
+      depth[g.start] = 0;
+      selected[g.start] = true;
+      queue.push(g.start);
+      stats.states = 1;
+    }
+    while (!queue.empty() && stats.states < budget) {
+      int s = queue.front();
+      queue.pop();
+      if (options.maxDepth >= 0 && depth[s] >= options.maxDepth)
+        continue;
+      for (const auto &e : g.out[s]) {
+        if (depth[e.to] != -1 || stats.states == budget)
+          continue;
+        depth[e.to] = depth[s] + 1;
+        selected[e.to] = true;
+        stats.states++;
+        queue.push(e.to);
+      }
+    }
+  } else {
+    stats.states = n;
+  }
+  stats.omittedStates = n - stats.states;
+
+  auto node = [&](int s) -> DotSink & {
+    return sink << options.nodePrefix << g.ids[s];
+  };
+
+  sink << "digraph " << name << " {\n";
+  sink << "  rankdir=LR;\n";
+  sink << "  node [shape=circle];\n";
+  for (int s : g.finals) {
+    if (!selected[s])
+      continue;
+    sink << "  ";
+    node(s) << " [shape=doublecircle];\n";
+  }
+
+  sink << "  start [shape=none, label=\"\"];\n";
+  if (g.start != -1 && selected[g.start]) {
+    sink << "  start -> ";
+    node(g.start) << ";\n";
+  }
+  if (stats.omittedStates > 0) {
+    sink << "  more [shape=box, style=dashed, label=\"" << stats.omittedStates
+         << " more states\"];\n";
+  }
+
+  // SCC clusters (iterative Tarjan over the selected subgraph)
+  if (options.clusterSCCs) {
+    std::vector<int> order(n, -1), low(n, 0), stack;
+    std::vector<bool> onStack(n, false);
+    std::vector<std::pair<int, size_t>> frames; // (state, next edge)
+    int counter = 0;
+    for (size_t root = 0; root < n; ++root) {
+      if (!selected[root] || order[root] != -1)
+        continue;
+      frames.push_back({static_cast<int>(root), 0});
+      while (!frames.empty()) {
+        auto &[s, edge] = frames.back();
+        if (edge == 0 && order[s] == -1) {
+          order[s] = low[s] = counter++;
+          stack.push_back(s);
+          onStack[s] = true;
+        }
+        if (edge < g.out[s].size()) {
+          int t = g.out[s][edge++].to;
+          if (!selected[t])
+            continue;
+          if (order[t] == -1)
+            frames.push_back({t, 0});
+          else if (onStack[t])
+            low[s] = std::min(low[s], order[t]);
+          continue;
+        }
+        int done = s;
+        frames.pop_back();
+        if (!frames.empty())
+          low[frames.back().first] =
+              std::min(low[frames.back().first], low[done]);
+        if (low[done] != order[done])
+          continue;
+
+        std::vector<int> component;
+        int member;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          onStack[member] = false;
+          component.push_back(member);
+        } while (member != done);
+        if (component.size() < 2)
+          continue;
+        sink << "  subgraph cluster_scc" << stats.clusters
+             << " {\n    style=dashed;\n    color=gray;\n";
+        for (int m : component) {
+          sink << "    ";
+          node(m) << ";\n";
+        }
+        sink << "  }\n";
+        stats.clusters++;
+      }
+    }
+  }
+
+  // Edges: per source, either one line per symbol (classic) or one line per
+  // target with a merged label. Cut edges always merge into "more".
+  std::vector<int> targets;
+  std::unordered_map<int, std::vector<char>> symbols;
+  std::unordered_map<int, bool> epsilon;
+  const int MORE = -1;
+  for (size_t s = 0; s < n; ++s) {
+    if (!selected[s])
+      continue;
+    targets.clear();
+    symbols.clear();
+    epsilon.clear();
+    for (const auto &e : g.out[s]) {
+      int target = selected[e.to] ? e.to : MORE;
+      if (!options.mergeEdges && target != MORE) {
+        sink << "  ";
+        node(s) << " -> ";
+        node(target) << " [label=\"";
+        if (e.epsilon) {
+          sink << "ε";
+        } else {
+          std::string label;
+          appendEscaped(label, e.symbol);
+          sink << label;
+        }
+        sink << "\"];\n";
+        stats.edges++;
+        continue;
+      }
+      if (!symbols.count(target) && !epsilon.count(target))
+        targets.push_back(target);
+      if (e.epsilon)
+        epsilon[target] = true;
+      else
+        symbols[target].push_back(e.symbol);
+    }
+
+    for (int target : targets) {
+      std::string label = rangeLabel(symbols[target]);
+      if (epsilon.count(target))
+        label += label.empty() ? "ε" : ",ε";
+      sink << "  ";
+      node(s) << " -> ";
+      if (target == MORE)
+        sink << "more";
+      else
+        node(target);
+      sink << " [label=\"" << label << "\"];\n";
+      stats.edges++;
+    }
+  }
+
+  sink << "}\n";
+  return stats;
+}
+
+} // namespace FormalSystem
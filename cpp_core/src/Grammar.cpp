@@ -0,0 +1,524 @@
+#include "Grammar.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace FormalSystem {
+
+// ====================== Loading ======================
+
+namespace {
+
+struct Token {
+  std::string text;
+  bool quoted;
+};
+
+std::string trim(const std::string &s) {
+  size_t begin = s.find_first_not_of(" \t\r");
+  if (begin == std::string::npos)
+    return "";
+  size_t end = s.find_last_not_of(" \t\r");
+  return s.substr(begin, end - begin + 1);
+}
+
+// Splits a right-hand side into words, quoted terminals and '|' separators
+std::vector<Token> lexAlternatives(const std::string &rhs, int lineNumber) {
+  std::vector<Token> tokens;
+  size_t i = 0;
+  while (i < rhs.size()) {
+    char c = rhs[i];
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      i++;
+    } else if (c == '|') {
+      tokens.push_back({"|", false});
+      i++;
+    } else if (c == '\'' || c == '"') {
+      size_t close = rhs.find(c, i + 1);
+      if (close == std::string::npos)
+        throw std::runtime_error("Line " + std::to_string(lineNumber) +
+                                 ": unterminated quote");
+      tokens.push_back({rhs.substr(i + 1, close - i - 1), true});
+      i = close + 1;
+    } else {
+      size_t end = i;
+      while (end < rhs.size() && rhs[end] != '|' && rhs[end] != '\'' &&
+             rhs[end] != '"' &&
+             !std::isspace(static_cast<unsigned char>(rhs[end])))
+        end++;
+      tokens.push_back({rhs.substr(i, end - i), false});
+      i = end;
+    }
+  }
+  return tokens;
+}
+
+} // namespace
+
+int Grammar::addNonterminal(const std::string &name) {
+  auto it = std::find(nonterminals.begin(), nonterminals.end(), name);
+  if (it != nonterminals.end())
+    return it - nonterminals.begin();
+  nonterminals.push_back(name);
+  return nonterminals.size() - 1;
+}
+
+int Grammar::addTerminal(const std::string &name) {
+  int existing = findTerminal(name);
+  if (existing != -1)
+    return existing;
+  terminals.push_back(name);
+  return terminals.size() - 1;
+}
+
+int Grammar::findTerminal(const std::string &name) const {
+  auto it = std::find(terminals.begin(), terminals.end(), name);
+  return it == terminals.end() ? -1 : it - terminals.begin();
+}
+
+Grammar Grammar::parse(const std::string &text) {
+  struct Rule {
+    int line;
+    std::string lhs;
+    std::vector<Token> rhs;
+  };
+  std::vector<Rule> rules;
+
+  std::istringstream in(text);
+  std::string line;
+  for (int number = 1; std::getline(in, line); ++number) {
+    size_t comment = line.find('#');
+    if (comment != std::string::npos)
+      line = line.substr(0, comment);
+    if (trim(line).empty())
+      continue;
+
+    size_t arrow = line.find("->");
+    size_t arrowLength = 2;
+    if (arrow == std::string::npos) {
+      arrow = line.find("→");
+      arrowLength = 3;
+    }
+    if (arrow == std::string::npos)
+      throw std::runtime_error("Line " + std::to_string(number) +
+                               ": expected '->'");
+    std::string lhs = trim(line.substr(0, arrow));
+    if (lhs.empty() || lhs.find_first_of(" \t") != std::string::npos)
+      throw std::runtime_error("Line " + std::to_string(number) +
+                               ": left-hand side must be one nonterminal");
+    std::string rhs = line.substr(arrow + arrowLength);
+    rules.push_back({number, lhs, lexAlternatives(rhs, number)});
+  }
+  if (rules.empty())
+    throw std::runtime_error("Grammar has no rules");
+
+  // Every left-hand side is a nonterminal; the first one is the start symbol
+  Grammar g;
+  for (const auto &rule : rules)
+    g.addNonterminal(rule.lhs);
+  bool compact =
+      std::all_of(g.nonterminals.begin(), g.nonterminals.end(),
+                  [](const std::string &n) { return n.size() == 1; });
+
+  auto isNonterminal = [&](const std::string &name) {
+    return std::find(g.nonterminals.begin(), g.nonterminals.end(), name) !=
+           g.nonterminals.end();
+  };
+
+  for (const auto &rule : rules) {
+    int lhs = g.addNonterminal(rule.lhs);
+    std::vector<int> rhs;
+    auto finish = [&]() {
+      g.productions.push_back({lhs, rhs});
+      rhs.clear();
+    };
+
+    for (const Token &token : rule.rhs) {
+      if (token.quoted) {
+        rhs.push_back(terminalSymbol(g.addTerminal(token.text)));
+      } else if (token.text == "|") {
+        finish();
+      } else if (token.text == "ε" || token.text == "eps" ||
+                 token.text == "epsilon") {
+        // Empty string
+      } else if (isNonterminal(token.text)) {
+        rhs.push_back(g.addNonterminal(token.text));
+      } else if (compact && token.text.size() > 1) {
+        for (char c : token.text) {
+          std::string symbol(1, c);
+          rhs.push_back(isNonterminal(symbol)
+                            ? g.addNonterminal(symbol)
+                            : terminalSymbol(g.addTerminal(symbol)));
+        }
+      } else {
+        rhs.push_back(terminalSymbol(g.addTerminal(token.text)));
+      }
+    }
+    finish();
+  }
+  return g;
+}
+
+std::vector<int> Grammar::tokenize(const std::string &text) const {
+  std::unordered_map<std::string, int> ids;
+  bool singleChars = true;
+  for (size_t t = 0; t < terminals.size(); ++t) {
+    ids[terminals[t]] = t;
+    singleChars = singleChars && terminals[t].size() == 1;
+  }
+  auto lookup = [&](const std::string &token) {
+    auto it = ids.find(token);
+    return it == ids.end() ? -1 : it->second;
+  };
+
+  std::vector<int> tokens;
+  if (singleChars) {
+    for (char c : text) {
+      if (!std::isspace(static_cast<unsigned char>(c)))
+        tokens.push_back(lookup(std::string(1, c)));
+    }
+  } else {
+    std::istringstream in(text);
+    std::string word;
+    while (in >> word)
+      tokens.push_back(lookup(word));
+  }
+  return tokens;
+}
+
+std::vector<bool> Grammar::nullable() const {
+  std::vector<bool> result(nonterminals.size(), false);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const auto &p : productions) {
+      if (result[p.lhs])
+        continue;
+      bool all = std::all_of(p.rhs.begin(), p.rhs.end(), [&](int s) {
+        return !isTerminal(s) && result[s];
+      });
+      if (all) {
+        result[p.lhs] = true;
+        changed = true;
+      }
+    }
+  }
+  return result;
+}
+
+bool Grammar::isCNF() const {
+  for (const auto &p : productions) {
+    if (p.rhs.empty() && p.lhs != start)
+      return false;
+    if (p.rhs.size() == 1 && !isTerminal(p.rhs[0]))
+      return false;
+    if (p.rhs.size() == 2 &&
+        (isTerminal(p.rhs[0]) || isTerminal(p.rhs[1]) || p.rhs[0] == start ||
+         p.rhs[1] == start))
+      return false;
+    if (p.rhs.size() > 2)
+      return false;
+  }
+  return true;
+}
+
+// ====================== CNF Conversion ======================
+
+Grammar Grammar::toCNF() const {
+  Grammar g = *this;
+  auto fresh = [&](std::string name) {
+    while (std::find(g.nonterminals.begin(), g.nonterminals.end(), name) !=
+           g.nonterminals.end())
+      name += "'";
+    return g.addNonterminal(name);
+  };
+
+  // START: a new start symbol that never occurs on a right-hand side
+  int oldStart = g.start;
+  g.start = fresh(g.nonterminals[oldStart] + "0");
+  g.productions.push_back({g.start, {oldStart}});
+
+  // TERM: terminals in rules of length >= 2 get their own nonterminal
+  std::map<int, int> terminalRule;
+  size_t count = g.productions.size();
+  for (size_t i = 0; i < count; ++i) {
+    if (g.productions[i].rhs.size() < 2)
+      continue;
+    for (size_t k = 0; k < g.productions[i].rhs.size(); ++k) {
+      int s = g.productions[i].rhs[k];
+      if (!isTerminal(s))
+        continue;
+      auto it = terminalRule.find(s);
+      if (it == terminalRule.end()) {
+        int nt = fresh("T_" + g.terminals[terminalSymbol(s)]);
+        it = terminalRule.emplace(s, nt).first;
+        g.productions.push_back({nt, {s}});
+      }
+      g.productions[i].rhs[k] = it->second;
+    }
+  }
+
+  // BIN: A -> X1 X2 ... Xk becomes a right-nested chain of binary rules
+  count = g.productions.size();
+  for (size_t i = 0; i < count; ++i) {
+    while (g.productions[i].rhs.size() > 2) {
+      std::vector<int> &rhs = g.productions[i].rhs;
+      int rest = fresh(g.nonterminals[g.productions[i].lhs] + "_");
+      std::vector<int> tail(rhs.end() - 2, rhs.end());
+      rhs.erase(rhs.end() - 2, rhs.end());
+      rhs.push_back(rest);
+      g.productions.push_back({rest, tail});
+    }
+  }
+
+  // DEL: drop epsilon rules, adding every variant without nullable symbols
+  std::vector<bool> nullable = g.nullable();
+  std::set<std::pair<int, std::vector<int>>> rules;
+  for (const auto &p : g.productions) {
+    if (p.rhs.size() == 2) {
+      rules.insert({p.lhs, p.rhs});
+      if (!isTerminal(p.rhs[0]) && nullable[p.rhs[0]])
+        rules.insert({p.lhs, {p.rhs[1]}});
+      if (!isTerminal(p.rhs[1]) && nullable[p.rhs[1]])
+        rules.insert({p.lhs, {p.rhs[0]}});
+    } else if (p.rhs.size() == 1) {
+      rules.insert({p.lhs, p.rhs});
+    }
+  }
+
+  // UNIT: A -> B is replaced by A -> (each non-unit rule of B)
+  size_t n = g.nonterminals.size();
+  std::vector<std::vector<int>> unit(n);
+  for (const auto &[lhs, rhs] : rules) {
+    if (rhs.size() == 1 && !isTerminal(rhs[0]))
+      unit[lhs].push_back(rhs[0]);
+  }
+
+  g.productions.clear();
+  std::set<std::pair<int, std::vector<int>>> seen;
+  for (size_t a = 0; a < n; ++a) {
+    std::vector<bool> reached(n, false);
+    std::vector<int> queue = {static_cast<int>(a)};
+    reached[a] = true;
+    for (size_t q = 0; q < queue.size(); ++q) {
+      for (int b : unit[queue[q]]) {
+        if (!reached[b]) {
+          reached[b] = true;
+          queue.push_back(b);
+        }
+      }
+    }
+    for (int b : queue) {
+      auto it = rules.lower_bound({b, {}});
+      for (; it != rules.end() && it->first == b; ++it) {
+        const std::vector<int> &rhs = it->second;
+        if (rhs.size() == 1 && !isTerminal(rhs[0]))
+          continue;
+        if (seen.insert({static_cast<int>(a), rhs}).second)
+          g.productions.push_back({static_cast<int>(a), rhs});
+      }
+    }
+  }
+  if (nullable[g.start])
+    g.productions.push_back({g.start, {}});
+  return g;
+}
+
+std::string Grammar::toString() const {
+  auto name = [&](int s) {
+    if (!isTerminal(s))
+      return nonterminals[s];
+    const std::string &t = terminals[terminalSymbol(s)];
+    bool plain = !t.empty() &&
+                 std::find(nonterminals.begin(), nonterminals.end(), t) ==
+                     nonterminals.end() &&
+                 t.find_first_of(" \t|'\"#") == std::string::npos;
+    return plain ? t : "'" + t + "'";
+  };
+
+  std::string out;
+  for (size_t a = 0; a < nonterminals.size(); ++a) {
+    std::string line;
+    for (const auto &p : productions) {
+      if (p.lhs != static_cast<int>(a))
+        continue;
+      line += line.empty() ? nonterminals[a] + " ->" : " |";
+      if (p.rhs.empty())
+        line += " ε";
+      for (int s : p.rhs)
+        line += " " + name(s);
+    }
+    if (!line.empty())
+      out += line + "\n";
+  }
+  return out;
+}
+
+// ====================== CYK ======================
+
+CYKParser::CYKParser(const Grammar &grammar)
+    : cnf(grammar.isCNF() ? grammar : grammar.toCNF()) {
+  byTerminal.resize(cnf.terminals.size());
+  for (const auto &p : cnf.productions) {
+    if (p.rhs.empty())
+      acceptsEmpty = acceptsEmpty || p.lhs == cnf.start;
+    else if (p.rhs.size() == 1)
+      byTerminal[Grammar::terminalSymbol(p.rhs[0])].push_back(p.lhs);
+    else
+      binary.push_back({p.lhs, p.rhs[0], p.rhs[1]});
+  }
+}
+
+bool CYKParser::recognize(const std::vector<int> &tokens) const {
+  size_t n = tokens.size();
+  if (n == 0)
+    return acceptsEmpty;
+
+  // ends[(i * N + B) * W ...]: bit e set iff B derives tokens[i, e)
+  // starts[(e * N + C) * W ...]: bit i set iff C derives tokens[i, e)
+  // Each row also keeps the range of its set bits, which bounds the words a
+  // split-point AND has to look at.
+  size_t N = cnf.nonterminals.size();
+  size_t W = (n + 1 + 63) / 64;
+  std::vector<uint64_t> ends(n * N * W, 0);
+  std::vector<uint64_t> starts((n + 1) * N * W, 0);
+  std::vector<int32_t> endsLo(n * N, INT32_MAX), endsHi(n * N, -1);
+  std::vector<int32_t> startsLo((n + 1) * N, INT32_MAX),
+      startsHi((n + 1) * N, -1);
+
+  auto endsRow = [&](size_t i, int b) { return &ends[(i * N + b) * W]; };
+  auto startsRow = [&](size_t e, int c) { return &starts[(e * N + c) * W]; };
+  auto test = [](const uint64_t *row, size_t bit) {
+    return (row[bit / 64] >> (bit % 64)) & 1;
+  };
+  auto add = [&](size_t i, size_t e, int a) {
+    endsRow(i, a)[e / 64] |= uint64_t(1) << (e % 64);
+    startsRow(e, a)[i / 64] |= uint64_t(1) << (i % 64);
+    size_t row = i * N + a, col = e * N + a;
+    endsLo[row] = std::min<int32_t>(endsLo[row], e);
+    endsHi[row] = std::max<int32_t>(endsHi[row], e);
+    startsLo[col] = std::min<int32_t>(startsLo[col], i);
+    startsHi[col] = std::max<int32_t>(startsHi[col], i);
+  };
+
+  for (size_t i = 0; i < n; ++i) {
+    int t = tokens[i];
+    if (t < 0 || t >= static_cast<int>(byTerminal.size()))
+      continue; // Unknown token: no span containing it is derivable
+    for (int a : byTerminal[t])
+      add(i, i + 1, a);
+  }
+
+  for (size_t len = 2; len <= n; ++len) {
+    for (size_t i = 0; i + len <= n; ++i) {
+      size_t j = i + len;
+      for (const BinaryRule &rule : binary) {
+        if (test(endsRow(i, rule.lhs), j))
+          continue;
+        // Split points m: B derives [i, m) and C derives [m, j)
+        size_t row = i * N + rule.left, col = j * N + rule.right;
+        int32_t lo = std::max(endsLo[row], startsLo[col]);
+        int32_t hi = std::min(endsHi[row], startsHi[col]);
+        if (lo > hi)
+          continue;
+        const uint64_t *left = endsRow(i, rule.left);
+        const uint64_t *right = startsRow(j, rule.right);
+        for (int32_t w = lo / 64; w <= hi / 64; ++w) {
+          if (left[w] & right[w]) {
+            add(i, j, rule.lhs);
+            break;
+          }
+        }
+      }
+    }
+  }
+  return test(endsRow(0, cnf.start), n);
+}
+
+// ====================== Earley ======================
+
+EarleyParser::EarleyParser(const Grammar &grammar)
+    : g(grammar), isNullable(grammar.nullable()) {
+  byLhs.resize(g.nonterminals.size());
+  for (size_t r = 0; r < g.productions.size(); ++r)
+    byLhs[g.productions[r].lhs].push_back(r);
+}
+
+bool EarleyParser::recognize(const std::vector<int> &tokens) const {
+  struct Item {
+    int rule, dot, origin;
+  };
+  size_t n = tokens.size();
+  std::vector<std::vector<Item>> sets(n + 1);
+  std::vector<std::unordered_set<uint64_t>> seen(n + 1);
+  // waiting[k][X]: items of set k whose next symbol is nonterminal X
+  std::vector<std::unordered_map<int, std::vector<Item>>> waiting(n + 1);
+
+  auto next = [&](const Item &item) {
+    const auto &rhs = g.productions[item.rule].rhs;
+    return item.dot < static_cast<int>(rhs.size()) ? rhs[item.dot] : 0;
+  };
+  auto complete = [&](const Item &item) {
+    return item.dot == static_cast<int>(g.productions[item.rule].rhs.size());
+  };
+  auto add = [&](size_t k, Item item) {
+    uint64_t key = (static_cast<uint64_t>(item.rule) << 40) ^
+                   (static_cast<uint64_t>(item.dot) << 32) ^
+                   static_cast<uint32_t>(item.origin);
+    if (!seen[k].insert(key).second)
+      return;
+    sets[k].push_back(item);
+    if (!complete(item) && !Grammar::isTerminal(next(item)))
+      waiting[k][next(item)].push_back(item);
+  };
+
+  for (int r : byLhs[g.start])
+    add(0, {r, 0, 0});
+
+  items = 0;
+  for (size_t k = 0; k <= n; ++k) {
+    for (size_t i = 0; i < sets[k].size(); ++i) {
+      Item item = sets[k][i];
+      if (complete(item)) {
+        int lhs = g.productions[item.rule].lhs;
+        auto it = waiting[item.origin].find(lhs);
+        if (it == waiting[item.origin].end())
+          continue;
+        // Index loop: adding to set k may extend this list when origin == k
+        std::vector<Item> &parents = it->second;
+        for (size_t w = 0; w < parents.size(); ++w) {
+          Item parent = parents[w];
+          add(k, {parent.rule, parent.dot + 1, parent.origin});
+        }
+      } else if (Grammar::isTerminal(next(item))) {
+        if (k < n && tokens[k] == Grammar::terminalSymbol(next(item)))
+          add(k + 1, {item.rule, item.dot + 1, item.origin});
+      } else {
+        int symbol = next(item);
+        for (int r : byLhs[symbol])
+          add(k, {r, 0, static_cast<int>(k)});
+        if (isNullable[symbol]) // Aycock-Horspool: skip over nullable
+          add(k, {item.rule, item.dot + 1, item.origin});
+      }
+    }
+    items += sets[k].size();
+    if (k < n && sets[k + 1].empty())
+      return false;
+    // Finished sets are only read through 'waiting' from now on
+    seen[k] = {};
+  }
+
+  for (const Item &item : sets[n]) {
+    if (item.origin == 0 && complete(item) &&
+        g.productions[item.rule].lhs == g.start)
+      return true;
+  }
+  return false;
+}
+
+} // namespace FormalSystem
@@ -0,0 +1,298 @@
+#include "IncrementalCompiler.h"
+#include "RegexEngine.h"
+#include "Stats.h"
+#include <algorithm>
+#include <iterator>
+#include <queue>
+#include <stack>
+#include <stdexcept>
+
+namespace FormalSystem {
+
+IncrementalCompiler::IncrementalCompiler() { clear(); }
+
+void IncrementalCompiler::clear() {
+  exprs.clear();
+  interned.clear();
+  derivatives.clear();
+  setIds.clear();
+  sets.clear();
+  setTransitions.clear();
+  stats = Stats();
+}
+
+// ====================== Hash-Consed Expressions ======================
+
+int IncrementalCompiler::make(Expr e) {
+  ExprKey key{e.kind, e.left, e.right, e.symbol, e.min, e.max};
+  auto it = interned.find(key);
+  if (it != interned.end())
+    return it->second;
+
+  switch (e.kind) {
+  case Expr::Epsilon:
+  case Expr::Star:
+    e.nullable = true;
+    break;
+  case Expr::Symbol:
+    e.nullable = false;
+    break;
+  case Expr::Concat:
+    e.nullable = exprs[e.left].nullable && exprs[e.right].nullable;
+    break;
+  case Expr::Union:
+    e.nullable = exprs[e.left].nullable || exprs[e.right].nullable;
+    break;
+  case Expr::Repeat:
+    e.nullable = e.min == 0 || exprs[e.left].nullable;
+    break;
+  }
+
+  exprs.push_back(e);
+  interned[key] = exprs.size() - 1;
+  return exprs.size() - 1;
+}
+
+int IncrementalCompiler::epsilon() { return make({Expr::Epsilon}); }
+
+int IncrementalCompiler::concat(int left, int right) {
+  if (exprs[left].kind == Expr::Epsilon)
+    return right;
+  if (exprs[right].kind == Expr::Epsilon)
+    return left;
+  Expr e{Expr::Concat};
+  e.left = left;
+  e.right = right;
+  return make(e);
+}
+
+int IncrementalCompiler::repeat(int inner, int min, int max) {
+  if (max == 0)
+    return epsilon();
+  if (min == 1 && max == 1)
+    return inner;
+  Expr e{min == 0 && max == -1 ? Expr::Star : Expr::Repeat};
+  e.left = inner;
+  if (e.kind == Expr::Repeat) {
+    e.min = min;
+    e.max = max;
+  }
+  return make(e);
+}
+
+// Union over byte edges of (byte range) . (target), built from the accepting
+// node up; hash-consing keeps the automaton's shared suffixes shared
+int IncrementalCompiler::byteClass(const Utf8Automaton &bytes,
+                                   std::set<char> &alphabet) {
+  std::vector<int> node(bytes.nodes.size(), epsilon());
+  for (size_t id = 1; id < bytes.nodes.size(); ++id) {
+    int result = -1;
+    for (const auto &edge : bytes.nodes[id]) {
+      int range = -1;
+      for (int b = edge.lo; b <= edge.hi; ++b) {
+        Expr e{Expr::Symbol};
+        e.symbol = static_cast<char>(b);
+        alphabet.insert(e.symbol);
+        range = range == -1 ? make(e) : make({Expr::Union, range, make(e)});
+      }
+      int part = concat(range, node[edge.target]);
+      result = result == -1 ? part : make({Expr::Union, result, part});
+    }
+    node[id] = result;
+  }
+  return node[bytes.start()];
+}
+
+// Partial derivative: the set of expressions matching what may follow
+// 'symbol' at the start of a word of 'expr' (the Antimirov NFA transitions)
+const IncrementalCompiler::ExprSet &
+IncrementalCompiler::derivative(int expr, char symbol) {
+  long long key = static_cast<long long>(expr) * 256 +
+                  static_cast<unsigned char>(symbol);
+  auto it = derivatives.find(key);
+  if (it != derivatives.end())
+    return it->second;
+
+  Expr e = exprs[expr]; // Copy: make() may grow the vector
+  ExprSet result;
+  auto append = [&](const ExprSet &parts, int tail) {
+    for (int part : parts)
+      result.push_back(tail == -1 ? part : concat(part, tail));
+  };
+
+  switch (e.kind) {
+  case Expr::Epsilon:
+    break;
+  case Expr::Symbol:
+    if (e.symbol == symbol)
+      result.push_back(epsilon());
+    break;
+  case Expr::Concat: {
+    ExprSet head = derivative(e.left, symbol);
+    append(head, e.right);
+    if (exprs[e.left].nullable)
+      append(derivative(e.right, symbol), -1);
+    break;
+  }
+  case Expr::Union: {
+    ExprSet lhs = derivative(e.left, symbol);
+    append(lhs, -1);
+    append(derivative(e.right, symbol), -1);
+    break;
+  }
+  case Expr::Star: {
+    ExprSet body = derivative(e.left, symbol);
+    append(body, expr);
+    break;
+  }
+  case Expr::Repeat: {
+    ExprSet body = derivative(e.left, symbol);
+    int rest = repeat(e.left, std::max(e.min - 1, 0),
+                      e.max == -1 ? -1 : e.max - 1);
+    append(body, rest);
+    break;
+  }
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return derivatives[key] = result;
+}
+
+// ====================== Memoized Determinization ======================
+
+int IncrementalCompiler::setId(const ExprSet &set) {
+  auto it = setIds.find(set);
+  if (it != setIds.end())
+    return it->second;
+  sets.push_back(set);
+  setTransitions.emplace_back();
+  setIds[set] = sets.size() - 1;
+  return sets.size() - 1;
+}
+
+int IncrementalCompiler::step(int set, char symbol) {
+  auto it = setTransitions[set].find(symbol);
+  if (it != setTransitions[set].end()) {
+    stats.reusedTransitions++;
+    FS_STAT_ADD(cacheHits, 1);
+    return it->second;
+  }
+
+  stats.computedTransitions++;
+  FS_STAT_ADD(cacheMisses, 1);
+  ExprSet next;
+  for (int expr : ExprSet(sets[set])) {
+    const ExprSet &d = derivative(expr, symbol);
+    ExprSet merged;
+    std::set_union(next.begin(), next.end(), d.begin(), d.end(),
+                   std::back_inserter(merged));
+    next.swap(merged);
+  }
+
+  int target = next.empty() ? -1 : setId(next);
+  setTransitions[set][symbol] = target;
+  return target;
+}
+
+DFA IncrementalCompiler::compile(const std::string &regex) {
+  FS_STAT_PHASE(Determinize);
+  if (static_cast<int>(exprs.size()) > MAX_EXPRESSIONS ||
+      static_cast<int>(sets.size()) > MAX_STATE_SETS)
+    clear();
+  stats.computedTransitions = 0;
+  stats.reusedTransitions = 0;
+  stats.tooLarge = false;
+
+  std::vector<RegexToken> tokens = RegexEngine::toPostfixTokens(regex);
+  std::stack<int> stack;
+  std::set<char> alphabet;
+
+  auto pop = [&](const char *error) {
+    if (stack.empty())
+      throw std::runtime_error(error);
+    int top = stack.top();
+    stack.pop();
+    return top;
+  };
+
+  for (const auto &token : tokens) {
+    if (token.type == RegexToken::Literal) {
+      Expr e{Expr::Symbol};
+      e.symbol = token.symbol;
+      stack.push(make(e));
+      alphabet.insert(token.symbol);
+    } else if (token.type == RegexToken::Class) {
+      stack.push(byteClass(*token.bytes, alphabet));
+    } else if (token.type == RegexToken::Concat) {
+      int right = pop("Invalid regex: concatenation missing operands");
+      int left = pop("Invalid regex: concatenation missing operands");
+      stack.push(concat(left, right));
+    } else if (token.type == RegexToken::Union) {
+      int right = pop("Invalid regex: union '|' missing operands");
+      int left = pop("Invalid regex: union '|' missing operands");
+      Expr e{Expr::Union};
+      e.left = left;
+      e.right = right;
+      stack.push(make(e));
+    } else if (token.type == RegexToken::Star) {
+      stack.push(repeat(pop("Invalid regex: '*' missing operand"), 0, -1));
+    } else if (token.type == RegexToken::Repeat) {
+      int inner = pop("Invalid regex: '{' missing operand");
+      stack.push(repeat(inner, token.min, token.max));
+    }
+    // Group markers only matter for capture extraction
+  }
+
+  DFA dfa;
+  dfa.alphabet = alphabet;
+  dfa.startStateId = 0;
+  if (stack.empty()) {
+    dfa.states[0] = {0, false, {}};
+    return dfa;
+  }
+
+  // BFS over memoized state sets, renumbered 0..n-1 for this pattern
+  std::map<int, int> local;
+  std::queue<int> queue;
+  int start = setId({stack.top()});
+  local[start] = 0;
+  queue.push(start);
+
+  while (!queue.empty()) {
+    int set = queue.front();
+    queue.pop();
+    int id = local[set];
+
+    bool isFinal = false;
+    for (int expr : sets[set])
+      isFinal = isFinal || exprs[expr].nullable;
+    dfa.states[id] = {id, isFinal, {}};
+    if (isFinal)
+      dfa.finalStateIds.insert(id);
+
+    for (char symbol : alphabet) {
+      int target = step(set, symbol);
+      if (target == -1)
+        continue;
+      if (!local.count(target)) {
+        if (static_cast<int>(local.size()) >= MAX_DFA_STATES) {
+          stats.tooLarge = true;
+          stats.expressions = exprs.size();
+          stats.stateSets = sets.size();
+          throw DFATooLargeError("DFA too large for incremental compile");
+        }
+        int next = local.size();
+        local[target] = next;
+        queue.push(target);
+      }
+      dfa.states[id].transitions[symbol] = local[target];
+    }
+  }
+
+  stats.expressions = exprs.size();
+  stats.stateSets = sets.size();
+  return dfa;
+}
+
+} // namespace FormalSystem
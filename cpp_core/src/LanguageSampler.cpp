@@ -0,0 +1,355 @@
+#include "LanguageSampler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace FormalSystem {
+
+namespace {
+
+// Unsigned big integer in base 10^9 (least significant limb first)
+using BigDec = std::vector<uint32_t>;
+const uint32_t BIG_BASE = 1000000000;
+
+// acc += x * k
+void addMul(BigDec &acc, const BigDec &x, uint32_t k) {
+  if (acc.size() < x.size())
+    acc.resize(x.size(), 0);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < acc.size(); ++i) {
+    uint64_t v = acc[i] + carry + (i < x.size() ? uint64_t(x[i]) * k : 0);
+    acc[i] = v % BIG_BASE;
+    carry = v / BIG_BASE;
+    if (carry == 0 && i >= x.size())
+      break;
+  }
+  while (carry > 0) {
+    acc.push_back(carry % BIG_BASE);
+    carry /= BIG_BASE;
+  }
+}
+
+std::string toDecimal(const BigDec &value) {
+  size_t top = value.size();
+  while (top > 0 && value[top - 1] == 0)
+    top--;
+  if (top == 0)
+    return "0";
+  std::string out = std::to_string(value[top - 1]);
+  for (size_t i = top - 1; i-- > 0;) {
+    std::string limb = std::to_string(value[i]);
+    out += std::string(9 - limb.size(), '0') + limb;
+  }
+  return out;
+}
+
+// Product of log2 matrices (b may be a single column). Each row of a and
+// column of b is shifted by its maximum and multiplied in doubles; an entry
+// whose sum comes out below 2^-900 of those maxima may have lost terms to
+// underflow and is redone term by term in log2, so a count far below the
+// others in its row never rounds to 0
+std::vector<double> multiplyLog2(const std::vector<double> &a,
+                                 const std::vector<double> &b, size_t n) {
+  const double none = -std::numeric_limits<double>::infinity();
+  size_t columns = b.size() / n; // n (matrix) or 1 (vector)
+  std::vector<double> columnTop(columns, none), scaled(b.size(), 0);
+  for (size_t k = 0; k < n; ++k) {
+    for (size_t j = 0; j < columns; ++j)
+      columnTop[j] = std::max(columnTop[j], b[k * columns + j]);
+  }
+  for (size_t k = 0; k < n; ++k) {
+    for (size_t j = 0; j < columns; ++j) {
+      if (!std::isinf(b[k * columns + j]))
+        scaled[k * columns + j] = std::exp2(b[k * columns + j] - columnTop[j]);
+    }
+  }
+
+  std::vector<double> c(n * columns, none), shifted(n), sum(columns);
+  for (size_t i = 0; i < n; ++i) {
+    const double *row = &a[i * n];
+    double rowTop = *std::max_element(row, row + n);
+    if (std::isinf(rowTop))
+      continue;
+    std::fill(sum.begin(), sum.end(), 0.0);
+    for (size_t k = 0; k < n; ++k) {
+      if (std::isinf(row[k]))
+        continue;
+      double x = std::exp2(row[k] - rowTop);
+      for (size_t j = 0; j < columns; ++j)
+        sum[j] += x * scaled[k * columns + j];
+    }
+    for (size_t j = 0; j < columns; ++j) {
+      if (sum[j] >= 0x1p-900) {
+        c[i * columns + j] = rowTop + columnTop[j] + std::log2(sum[j]);
+        continue;
+      }
+      double top = none, exact = 0;
+      for (size_t k = 0; k < n; ++k)
+        top = std::max(top, row[k] + b[k * columns + j]);
+      if (std::isinf(top))
+        continue;
+      for (size_t k = 0; k < n; ++k)
+        exact += std::exp2(row[k] + b[k * columns + j] - top);
+      c[i * columns + j] = top + std::log2(exact);
+    }
+  }
+  return c;
+}
+
+} // namespace
+
+LanguageSampler::LanguageSampler(const DFA &dfa, int maxLength)
+    : tableLength(std::max(maxLength, 0)), rng(std::random_device{}()) {
+  if (dfa.startStateId != -1 && dfa.states.count(dfa.startStateId)) {
+    // Start state first, then the remaining states in ID order
+    std::unordered_map<int, int32_t> dense;
+    std::vector<int> ids{dfa.startStateId};
+    dense[dfa.startStateId] = 0;
+    for (const auto &[id, state] : dfa.states) {
+      if (id != dfa.startStateId) {
+        dense[id] = ids.size();
+        ids.push_back(id);
+      }
+    }
+
+    bool seen[256] = {};
+    table.assign(ids.size() * 256, -1);
+    groups.resize(ids.size());
+    for (size_t s = 0; s < ids.size(); ++s) {
+      const auto &state = dfa.states.at(ids[s]);
+      accepting.push_back(dfa.finalStateIds.count(state.id) ? 1 : 0);
+      std::map<int32_t, std::vector<char>> byTarget;
+      for (const auto &[symbol, nextId] : state.transitions) {
+        auto it = dense.find(nextId);
+        if (it == dense.end())
+          continue;
+        table[s * 256 + static_cast<unsigned char>(symbol)] = it->second;
+        byTarget[it->second].push_back(symbol);
+        seen[static_cast<unsigned char>(symbol)] = true;
+      }
+      for (const auto &[target, chars] : byTarget) {
+        groups[s].push_back({target, static_cast<int32_t>(symbols.size()),
+                             static_cast<int32_t>(chars.size())});
+        symbols.insert(symbols.end(), chars.begin(), chars.end());
+      }
+    }
+    for (int c = 0; c < 256; ++c) {
+      if (seen[c])
+        alphabet += static_cast<char>(c);
+    }
+    start = 0;
+  }
+
+  // Row k from row k-1 in log2 space: W[k][s] = sum over groups of
+  // size * W[k-1][target], so a state far below the row maximum keeps its
+  // own exponent instead of underflowing to 0
+  const double none = -std::numeric_limits<double>::infinity();
+  size_t n = accepting.size();
+  logWeights.assign((tableLength + 1) * n, none);
+  for (size_t s = 0; s < n; ++s)
+    logWeights[s] = accepting[s] ? 0 : none;
+  std::vector<double> terms;
+  for (int k = 1; k <= tableLength; ++k) {
+    const double *prev = &logWeights[(k - 1) * n];
+    double *row = &logWeights[k * n];
+    for (size_t s = 0; s < n; ++s) {
+      terms.clear();
+      double top = none;
+      for (const auto &g : groups[s]) {
+        if (std::isinf(prev[g.target]))
+          continue;
+        terms.push_back(std::log2(g.size) + prev[g.target]);
+        top = std::max(top, terms.back());
+      }
+      if (terms.empty())
+        continue;
+      double sum = 0;
+      for (double t : terms)
+        sum += std::exp2(t - top);
+      row[s] = top + std::log2(sum);
+    }
+  }
+}
+
+double LanguageSampler::log2Count(uint64_t length) const {
+  const double none = -std::numeric_limits<double>::infinity();
+  if (start == -1)
+    return none;
+  size_t n = accepting.size();
+  if (length <= static_cast<uint64_t>(tableLength))
+    return logWeights[length * n + start];
+  if (static_cast<int>(n) > MAX_MATRIX_STATES)
+    throw std::runtime_error("Too many states to count strings of length " +
+                             std::to_string(length));
+
+  // W[length] = M^(length - maxLength) W[maxLength], by repeated squaring
+  std::vector<double> power(n * n, 0);
+  for (size_t s = 0; s < n; ++s) {
+    for (const auto &g : groups[s])
+      power[s * n + g.target] += g.size;
+  }
+  for (double &p : power)
+    p = p > 0 ? std::log2(p) : none;
+  std::vector<double> vector(logWeights.begin() + tableLength * n,
+                             logWeights.end());
+  for (uint64_t e = length - tableLength; e > 0; e >>= 1) {
+    if (e & 1)
+      vector = multiplyLog2(power, vector, n);
+    if (e > 1)
+      power = multiplyLog2(power, power, n);
+  }
+  return vector[start];
+}
+
+std::string LanguageSampler::countExact(int length) const {
+  if (start == -1 || length < 0)
+    return "0";
+  size_t n = accepting.size();
+  std::vector<BigDec> prev(n), row(n);
+  for (size_t s = 0; s < n; ++s)
+    prev[s] = {accepting[s]};
+  for (int k = 1; k <= length; ++k) {
+    for (size_t s = 0; s < n; ++s) {
+      row[s].clear();
+      for (const auto &g : groups[s])
+        addMul(row[s], prev[g.target], g.size);
+    }
+    prev.swap(row);
+  }
+  return toDecimal(prev[start]);
+}
+
+// ====================== Sampling ======================
+
+bool LanguageSampler::accepts(const std::string &input) const {
+  int32_t state = start;
+  for (size_t i = 0; i < input.size() && state != -1; ++i)
+    state = table[state * 256 + static_cast<unsigned char>(input[i])];
+  return state != -1 && accepting[state];
+}
+
+// Length drawn in proportion to its number of accepted strings
+int LanguageSampler::pickLength(int minLength, int maxLength) {
+  if (maxLength > tableLength)
+    throw std::runtime_error("Sample length " + std::to_string(maxLength) +
+                             " exceeds the sampler's maximum of " +
+                             std::to_string(tableLength));
+  minLength = std::max(minLength, 0);
+  if (start == -1 || minLength > maxLength)
+    return -1;
+  if (minLength != cdfMin || maxLength != cdfMax) {
+    double top = -std::numeric_limits<double>::infinity();
+    for (int k = minLength; k <= maxLength; ++k)
+      top = std::max(top, log2Count(k));
+    lengthCdf.clear();
+    double total = 0;
+    for (int k = minLength; k <= maxLength; ++k) {
+      double log2 = log2Count(k);
+      total += std::isinf(log2) ? 0 : std::exp2(log2 - top);
+      lengthCdf.push_back(total);
+    }
+    cdfMin = minLength;
+    cdfMax = maxLength;
+  }
+  if (lengthCdf.back() == 0)
+    return -1;
+  std::uniform_real_distribution<double> uniform(0, lengthCdf.back());
+  size_t i = std::upper_bound(lengthCdf.begin(), lengthCdf.end(),
+                              uniform(rng)) -
+             lengthCdf.begin();
+  return minLength + std::min(i, lengthCdf.size() - 1);
+}
+
+// Each step picks a target in proportion to the strings it can complete
+void LanguageSampler::walk(int length, std::string &out) {
+  size_t n = accepting.size();
+  out.clear();
+  int32_t state = start;
+  for (int remaining = length; remaining > 0; --remaining) {
+    // Group weights relative to W[remaining][state] sum to 1
+    const double *row = &logWeights[(remaining - 1) * n];
+    double total = logWeights[remaining * n + state];
+    double u = (rng() >> 11) * 0x1p-53; // Uniform in [0, 1)
+    const Group *chosen = nullptr;
+    double w = 0;
+    for (const auto &g : groups[state]) {
+      if (std::isinf(row[g.target]))
+        continue;
+      chosen = &g; // Last candidate absorbs rounding
+      w = g.size * std::exp2(row[g.target] - total);
+      if (u < w)
+        break;
+      u -= w;
+    }
+    // What is left of u is uniform within the group: reuse it for the symbol
+    int32_t pick = std::min<int32_t>(u / w * chosen->size, chosen->size - 1);
+    out += symbols[chosen->first + std::max(pick, 0)];
+    state = chosen->target;
+  }
+}
+
+bool LanguageSampler::sample(int minLength, int maxLength, std::string &out) {
+  int length = pickLength(minLength, maxLength);
+  if (length == -1)
+    return false;
+  walk(length, out);
+  return true;
+}
+
+bool LanguageSampler::nearMiss(int minLength, int maxLength,
+                               std::string &out) {
+  std::string accepted;
+  if (!sample(minLength, maxLength, accepted))
+    return false;
+  for (int attempt = 0; attempt < 32 && !alphabet.empty(); ++attempt) {
+    out = accepted;
+    char symbol = alphabet[rng() % alphabet.size()];
+    size_t at = rng() % (out.size() + 1);
+    switch (out.empty() ? 0 : rng() % 3) {
+    case 0:
+      out.insert(out.begin() + at, symbol);
+      break;
+    case 1:
+      out.erase(std::min(at, out.size() - 1), 1);
+      break;
+    default:
+      out[std::min(at, out.size() - 1)] = symbol;
+      break;
+    }
+    if (!accepts(out))
+      return true;
+  }
+
+  // Every in-alphabet edit was accepted: insert a byte the DFA never reads,
+  // preferring printable ones (from '!' upwards, wrapping around)
+  for (int i = 0; i < 256; ++i) {
+    char c = static_cast<char>((i + '!') & 0xFF);
+    if (alphabet.find(c) != std::string::npos)
+      continue;
+    out = accepted;
+    out.insert(out.begin() + rng() % (out.size() + 1), c);
+    return true;
+  }
+  return false;
+}
+
+size_t LanguageSampler::generate(size_t count, int minLength, int maxLength,
+                                 double nearMissRate, std::string &bytes,
+                                 std::vector<int32_t> &ends) {
+  std::bernoulli_distribution miss(std::clamp(nearMissRate, 0.0, 1.0));
+  std::string word;
+  for (size_t i = 0; i < count; ++i) {
+    bool ok = miss(rng) ? nearMiss(minLength, maxLength, word)
+                        : sample(minLength, maxLength, word);
+    if (!ok)
+      return i;
+    bytes += word;
+    ends.push_back(bytes.size());
+  }
+  return count;
+}
+
+} // namespace FormalSystem
@@ -1,59 +1,74 @@
 #include "Matcher.h"
+#include "Stats.h"
 #include <algorithm>
-#include <iostream>
 #include <vector>
 
 namespace FormalSystem {
 
-bool Matcher::approximateMatch(const std::string &text,
-                               const std::string &pattern, int maxErrors) {
-  int n = text.size();
-  int m = pattern.size();
-
-  std::vector<std::vector<int>> dp(n + 1, std::vector<int>(m + 1));
-
-  for (int j = 0; j <= m; j++) {
-    dp[0][j] = j; // Cost to match pattern prefix with empty text prefix
-  }
+// Sellers' DP kept as a single column: column[j] is the best cost of matching
+// pattern[0..j) against a substring ending at the current text position
+// (free start, so column[0] is always 0). onEnd(i) is called for every end
+// offset whose cost is within maxErrors and returns false to stop the scan.
+template <typename OnEnd>
+static void scanEnds(const char *text, size_t n, const std::string &pattern,
+                     int maxErrors, OnEnd onEnd) {
+  size_t m = pattern.size();
+  std::vector<int> column(m + 1);
+  for (size_t j = 0; j <= m; j++)
+    column[j] = j; // Cost to match pattern prefix with empty text prefix
+  if (column[m] <= maxErrors && !onEnd(0))
+    return;
 
-  for (int i = 1; i <= n; i++) {
-    dp[i][0] = 0; // Cost to match empty pattern with text prefix (0 because we
-                  // can start match anywhere)
-    for (int j = 1; j <= m; j++) {
-      if (text[i - 1] == pattern[j - 1]) {
-        dp[i][j] = dp[i - 1][j - 1];
+  size_t i = 1;
+  for (; i <= n; i++) {
+    char c = text[i - 1];
+    int diagonal = column[0]; // dp[i - 1][j - 1]
+    for (size_t j = 1; j <= m; j++) {
+      int above = column[j]; // dp[i - 1][j]
+      if (c == pattern[j - 1]) {
+        column[j] = diagonal;
       } else {
-        dp[i][j] = 1 + std::min({
-                           dp[i - 1][j],    // Deletion
-                           dp[i][j - 1],    // Insertion
-                           dp[i - 1][j - 1] // Substitution
-                       });
+        column[j] = 1 + std::min({
+                            above,         // Deletion
+                            column[j - 1], // Insertion
+                            diagonal       // Substitution
+                        });
       }
+      diagonal = above;
     }
+    if (column[m] <= maxErrors && !onEnd(i))
+      break;
   }
+  FS_STAT_ADD(bytesScanned, std::min(i, n));
+  FS_STAT_ADD(dpCells, std::min(i, n) * m);
+}
 
-  // Check if any ending position in text satisfies the maxErrors constraint
-  for (int i = m; i <= n;
-       i++) { // Must match at least m chars roughly? No, i can be anything >= 0
-              // technically but usually >= m-k
-    // Actually, we just check the last column for any row i
-    if (dp[i][m] <= maxErrors) {
-      return true;
-    }
-  }
-
-  // Also check smaller prefixes if pattern is longer than text? No, usually not
-  // for search. But let's stick to the logic: "Can we find pattern in text with
-  // <= k errors?" The loop `for (int i = 0; i <= n; i++)` checking `dp[i][m]`
-  // is correct for substring search. The previous code started loop at m, which
-  // is a safe optimization.
+bool Matcher::approximateMatch(const std::string &text,
+                               const std::string &pattern, int maxErrors) {
+  return approximateMatch(text.data(), text.size(), pattern, maxErrors);
+}
 
-  for (int i = 0; i <= n; i++) {
-    if (dp[i][m] <= maxErrors)
-      return true;
-  }
+bool Matcher::approximateMatch(const char *text, size_t length,
+                               const std::string &pattern, int maxErrors) {
+  FS_STAT_PHASE(Match);
+  bool found = false;
+  scanEnds(text, length, pattern, maxErrors, [&](size_t) {
+    found = true;
+    return false;
+  });
+  return found;
+}
 
-  return false;
+size_t Matcher::approximateMatchEnds(const char *text, size_t length,
+                                     const std::string &pattern, int maxErrors,
+                                     std::vector<int32_t> &ends) {
+  FS_STAT_PHASE(Match);
+  ends.clear();
+  scanEnds(text, length, pattern, maxErrors, [&](size_t i) {
+    ends.push_back(static_cast<int32_t>(i));
+    return true;
+  });
+  return ends.size();
 }
 
 } // namespace FormalSystem
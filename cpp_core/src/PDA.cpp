@@ -1,45 +1,502 @@
 #include "PDA.h"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <stdexcept>
+#include <unordered_set>
 
 namespace FormalSystem {
 
+// ====================== General PDA ======================
+
+void PushdownAutomaton::addTransition(int from, int input, int top, int to,
+                                      bool pop, std::vector<int> push) {
+  transitions.push_back({from, input, top, to, pop, std::move(push)});
+  deterministic = -1;
+}
+
+// Two transitions conflict if some configuration enables both
+static bool conflicts(const PushdownAutomaton::Transition &a,
+                      const PushdownAutomaton::Transition &b) {
+  using P = PushdownAutomaton;
+  if (a.from != b.from)
+    return false;
+  bool inputs = a.input == b.input || a.input == P::ANY || b.input == P::ANY ||
+                a.input == P::EPSILON || b.input == P::EPSILON;
+  bool tops = a.top == b.top || a.top == P::ANY || b.top == P::ANY;
+  if ((a.top == P::ANY && a.pop && b.top == P::EMPTY) ||
+      (b.top == P::ANY && b.pop && a.top == P::EMPTY))
+    tops = false;
+  return inputs && tops;
+}
+
+bool PushdownAutomaton::isDeterministic() const {
+  if (deterministic != -1)
+    return deterministic;
+
+  index.clear();
+  deterministic = 1;
+  std::unordered_map<int, std::vector<int>> byState;
+  for (size_t i = 0; i < transitions.size(); ++i)
+    byState[transitions[i].from].push_back(i);
+
+  for (const auto &[state, ids] : byState) {
+    for (size_t i = 0; i < ids.size() && deterministic; ++i) {
+      for (size_t j = i + 1; j < ids.size(); ++j) {
+        if (conflicts(transitions[ids[i]], transitions[ids[j]])) {
+          deterministic = 0;
+          break;
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < transitions.size(); ++i) {
+    const Transition &t = transitions[i];
+    index.emplace(Key{t.from, t.input, t.top}, i);
+  }
+  return deterministic;
+}
+
+const PushdownAutomaton::Transition *
+PushdownAutomaton::find(int state, int input, int top) const {
+  const int inputs[] = {input, input == EPSILON ? EPSILON : ANY};
+  const int tops[] = {top, ANY};
+  for (int in : inputs) {
+    for (int tp : tops) {
+      auto it = index.find({state, in, tp});
+      if (it == index.end())
+        continue;
+      const Transition &t = transitions[it->second];
+      if (!(t.pop && top == EMPTY))
+        return &t;
+    }
+  }
+  return nullptr;
+}
+
+bool PushdownAutomaton::accepts(int state, bool stackEmpty) const {
+  if (acceptOnEmptyStack && !stackEmpty)
+    return false;
+  return acceptStates.empty() || acceptStates.count(state);
+}
+
+std::string PushdownAutomaton::inputName(int symbol) const {
+  if (symbol >= 0 && symbol < static_cast<int>(inputNames.size()))
+    return inputNames[symbol];
+  return std::to_string(symbol);
+}
+
+std::string PushdownAutomaton::stackName(int symbol) const {
+  if (symbol >= 0 && symbol < static_cast<int>(stackNames.size()))
+    return stackNames[symbol];
+  return std::to_string(symbol);
+}
+
+PushdownAutomaton::Result
+PushdownAutomaton::run(const std::vector<int> &input,
+                       std::vector<std::string> *log) const {
+  return isDeterministic() ? runDeterministic(input, log)
+                           : runNondeterministic(input, log);
+}
+
+PushdownAutomaton::Result
+PushdownAutomaton::runDeterministic(const std::vector<int> &input,
+                                    std::vector<std::string> *log) const {
+  isDeterministic(); // Builds the index
+  std::vector<int> stack;
+  size_t pos = 0;
+  size_t epsilonSteps = 0;
+  int state = startState;
+  if (log)
+    log->push_back("Start: Stack empty");
+
+  while (true) {
+    int top = stack.empty() ? EMPTY : stack.back();
+    const Transition *t = nullptr;
+    if (pos < input.size())
+      t = find(state, input[pos], top);
+    bool consumed = t != nullptr;
+    if (!t)
+      t = find(state, EPSILON, top);
+    if (!t || (!consumed && ++epsilonSteps > MAX_CONFIGURATIONS))
+      break;
+
+    if (t->pop)
+      stack.pop_back();
+    stack.insert(stack.end(), t->push.begin(), t->push.end());
+    state = t->to;
+
+    if (log) {
+      std::string entry =
+          consumed ? "Read '" + inputName(input[pos]) + "': " : "Epsilon: ";
+      if (t->pop)
+        entry += "Pop '" + stackName(top) + "'";
+      for (size_t i = 0; i < t->push.size(); ++i)
+        entry += (i || t->pop ? ", Push '" : "Push '") +
+                 stackName(t->push[i]) + "'";
+      if (!t->pop && t->push.empty())
+        entry += "No stack change";
+      log->push_back(entry + " -> Stack size: " + std::to_string(stack.size()));
+    }
+    if (consumed) {
+      pos++;
+      epsilonSteps = 0;
+    }
+  }
+
+  int top = stack.empty() ? EMPTY : stack.back();
+  Result result{pos == input.size() && accepts(state, stack.empty()), pos,
+                state, top, stack.size()};
+
+  if (log) {
+    if (pos < input.size()) {
+      log->push_back("Read '" + inputName(input[pos]) +
+                     "': No transition " +
+                     (stack.empty() ? std::string("(stack empty)")
+                                    : "(top '" + stackName(top) + "')") +
+                     ". REJECT");
+    } else if (result.accepted) {
+      log->push_back(acceptOnEmptyStack ? "End: Stack empty. ACCEPT"
+                                        : "End: ACCEPT");
+    } else if (acceptOnEmptyStack && !stack.empty()) {
+      log->push_back("End: Stack not empty. REJECT");
+    } else {
+      log->push_back("End: State " + std::to_string(state) +
+                     " not accepting. REJECT");
+    }
+  }
+  return result;
+}
+
+PushdownAutomaton::Result
+PushdownAutomaton::runNondeterministic(const std::vector<int> &input,
+                                       std::vector<std::string> *log) const {
+  // Stacks are interned linked nodes, so a configuration is (state, node)
+  struct StackNode {
+    int symbol;
+    int parent;
+  };
+  std::vector<StackNode> nodes;
+  std::unordered_map<long long, int> interned;
+  auto push = [&](int parent, int symbol) {
+    long long key = (static_cast<long long>(symbol) << 32) ^
+                    static_cast<unsigned>(parent + 1);
+    auto it = interned.find(key);
+    if (it != interned.end())
+      return it->second;
+    nodes.push_back({symbol, parent});
+    interned[key] = nodes.size() - 1;
+    return static_cast<int>(nodes.size() - 1);
+  };
+
+  std::unordered_map<int, std::vector<const Transition *>> byState;
+  for (const auto &t : transitions)
+    byState[t.from].push_back(&t);
+
+  struct Config {
+    int state;
+    int stack; // -1 = empty
+  };
+  auto configKey = [](const Config &c) {
+    return (static_cast<long long>(c.state) << 32) ^
+           static_cast<unsigned>(c.stack + 1);
+  };
+  auto apply = [&](const Config &c, const Transition &t) {
+    int s = c.stack;
+    if (t.pop)
+      s = nodes[s].parent;
+    for (int symbol : t.push)
+      s = push(s, symbol);
+    return Config{t.to, s};
+  };
+  auto enabled = [&](const Config &c, const Transition &t) {
+    int top = c.stack == -1 ? EMPTY : nodes[c.stack].symbol;
+    if (t.pop && top == EMPTY)
+      return false;
+    return t.top == ANY || t.top == top;
+  };
+
+  std::vector<Config> current = {{startState, -1}};
+  size_t explored = 0;
+  if (log)
+    log->push_back("Start: Nondeterministic search (breadth-first)");
+
+  for (size_t pos = 0;; ++pos) {
+    // Epsilon closure at this position, skipping configurations already seen.
+    // Counted as it grows: an epsilon push loop never repeats a configuration
+    auto count = [&](size_t n) {
+      explored += n;
+      if (explored > MAX_CONFIGURATIONS)
+        throw std::runtime_error(
+            "PDA search exceeded the configuration limit");
+    };
+    count(current.size());
+    std::unordered_set<long long> seen;
+    for (const auto &c : current)
+      seen.insert(configKey(c));
+    for (size_t i = 0; i < current.size(); ++i) {
+      Config c = current[i];
+      for (const Transition *t : byState[c.state]) {
+        if (t->input != EPSILON || !enabled(c, *t))
+          continue;
+        Config next = apply(c, *t);
+        if (seen.insert(configKey(next)).second) {
+          current.push_back(next);
+          count(1);
+        }
+      }
+    }
+    if (log)
+      log->push_back("Position " + std::to_string(pos) + ": " +
+                     std::to_string(current.size()) + " configurations");
+
+    if (pos == input.size()) {
+      for (const auto &c : current) {
+        if (accepts(c.state, c.stack == -1)) {
+          if (log)
+            log->push_back("End: Accepting configuration found. ACCEPT");
+          return {true, pos, c.state, EMPTY, 0};
+        }
+      }
+      if (log)
+        log->push_back("End: No accepting configuration. REJECT");
+      return {false, pos, startState, EMPTY, 0};
+    }
+
+    std::vector<Config> next;
+    std::unordered_set<long long> nextSeen;
+    for (const auto &c : current) {
+      for (const Transition *t : byState[c.state]) {
+        if (t->input == EPSILON || !enabled(c, *t))
+          continue;
+        if (t->input != ANY && t->input != input[pos])
+          continue;
+        Config n = apply(c, *t);
+        if (nextSeen.insert(configKey(n)).second)
+          next.push_back(n);
+      }
+    }
+
+    if (next.empty()) {
+      if (log)
+        log->push_back("Read '" + inputName(input[pos]) +
+                       "': No configuration survives. REJECT");
+      return {false, pos, startState, EMPTY, 0};
+    }
+    current.swap(next);
+  }
+}
+
+// ====================== Trace Buffer ======================
+
+PDATrace::PDATrace(size_t capacity) : events(capacity) {}
+
+void PDATrace::clear() {
+  next = 0;
+  total = 0;
+}
+
+const PDATrace::Event *PDATrace::data() {
+  if (total > events.size() && next != 0) {
+    std::rotate(events.begin(), events.begin() + next, events.end());
+    next = 0;
+  }
+  return events.data();
+}
+
+// ====================== a^n b^n ======================
+
 bool PDA::simulate(const std::string &input, std::vector<std::string> &log) {
-  std::stack<char> st;
-  int i = 0;
+  // Start, one event per symbol and at most two end events
+  PDATrace trace(input.size() + 3);
+  bool result = simulate(input, &trace);
+
   log.clear();
-  log.push_back("Start: Stack empty");
+  const PDATrace::Event *events = trace.data();
+  for (size_t i = 0; i < trace.size(); ++i)
+    log.push_back(describe(events[i]));
+  return result;
+}
+
+bool PDA::simulate(const std::string &input, PDATrace *trace) {
+  return simulate(input.data(), input.size(), trace);
+}
+
+bool PDA::simulate(const char *input, size_t length, PDATrace *trace) {
+  // The only stack symbol is 'A', so the stack is just its depth
+  size_t depth = 0;
+  size_t i = 0;
+  auto record = [&](PDATrace::Op op, char symbol) {
+    if (trace)
+      trace->record(op, symbol, depth, i);
+  };
+  record(PDATrace::Start, 0);
 
   // Push phase: read a's
-  while (i < input.size() && input[i] == 'a') {
-    st.push('A');
-    log.push_back("Read 'a': Push 'A' -> Stack size: " +
-                  std::to_string(st.size()));
+  while (i < length && input[i] == 'a') {
+    depth++;
+    record(PDATrace::Push, 'a');
     i++;
   }
 
   // Pop phase: read b's
-  while (i < input.size() && input[i] == 'b') {
-    if (st.empty()) {
-      log.push_back("Read 'b': Stack empty! REJECT");
+  while (i < length && input[i] == 'b') {
+    if (depth == 0) {
+      record(PDATrace::RejectEmptyStack, 'b');
       return false;
     }
-    st.pop();
-    log.push_back("Read 'b': Pop 'A' -> Stack size: " +
-                  std::to_string(st.size()));
+    depth--;
+    record(PDATrace::Pop, 'b');
     i++;
   }
 
   // Check if we consumed all input and stack is empty
-  if (i == input.size() && st.empty()) {
-    log.push_back("End: Stack empty. ACCEPT");
+  if (i == length && depth == 0) {
+    record(PDATrace::Accept, 0);
     return true;
-  } else {
-    if (i != input.size())
-      log.push_back("End: Input not fully consumed. REJECT");
-    if (!st.empty())
-      log.push_back("End: Stack not empty. REJECT");
-    return false;
   }
+  if (i != length)
+    record(PDATrace::RejectInput, 0);
+  if (depth != 0)
+    record(PDATrace::RejectStack, 0);
+  return false;
+}
+
+std::string PDA::describe(const PDATrace::Event &event) {
+  std::string read = "Read '" + std::string(1, char(event.symbol)) + "': ";
+  std::string size = " -> Stack size: " + std::to_string(event.depth);
+  switch (event.op) {
+  case PDATrace::Start:
+    return "Start: Stack empty";
+  case PDATrace::Push:
+    return read + "Push 'A'" + size;
+  case PDATrace::Pop:
+    return read + "Pop 'A'" + size;
+  case PDATrace::RejectEmptyStack:
+    return read + "Stack empty! REJECT";
+  case PDATrace::RejectInput:
+    return "End: Input not fully consumed. REJECT";
+  case PDATrace::RejectStack:
+    return "End: Stack not empty. REJECT";
+  case PDATrace::Accept:
+    return "End: Stack empty. ACCEPT";
+  }
+  return "Unknown event";
+}
+
+// ====================== Language Checkers ======================
+
+bool PDA::checkBalanced(const std::string &input,
+                        std::vector<std::string> &log, int minLoop) {
+  using P = PushdownAutomaton;
+  // States 0..minLoop: a '(' was just pushed and k bases read since (k
+  // saturates at minLoop). State closed: anything else. Stack symbol 0 = '('.
+  const int closed = minLoop + 1;
+  const int open = '(', close = ')';
+
+  P pda;
+  log.clear();
+  pda.startState = closed;
+  pda.inputNames.resize(256);
+  pda.stackNames = {"("};
+
+  std::set<unsigned char> bases;
+  std::vector<int> symbols;
+  for (char c : input) {
+    unsigned char u = c;
+    symbols.push_back(u);
+    pda.inputNames[u] = std::string(1, c);
+    if (c != open && c != close)
+      bases.insert(u);
+  }
+
+  for (int q = 0; q <= closed; ++q) {
+    pda.addTransition(q, open, P::ANY, 0, false, {0});
+    for (int base : bases)
+      pda.addTransition(q, base, P::ANY, q == closed ? closed
+                                                     : std::min(q + 1, minLoop),
+                        false);
+  }
+  pda.addTransition(minLoop, close, 0, closed, true);
+  pda.addTransition(closed, close, 0, closed, true);
+
+  P::Result result = pda.run(symbols, &log);
+  if (!result.accepted && result.position < input.size()) {
+    if (result.top == P::EMPTY)
+      log.push_back("Error: ')' without matching '(' (Empty Stack)");
+    else
+      log.push_back("Error: Loop size " + std::to_string(result.state) +
+                    " < " + std::to_string(minLoop) + " (Steric Hindrance)");
+  }
+  return result.accepted;
+}
+
+bool PDA::checkXML(const std::string &input, std::vector<std::string> &log) {
+  using P = PushdownAutomaton;
+  P pda;
+  std::unordered_map<std::string, int> tagIds;    // Name -> stack symbol
+  std::unordered_map<std::string, int> symbolIds; // Log name -> input symbol
+  std::vector<int> symbols;
+  log.clear();
+
+  auto symbolFor = [&](const std::string &name) {
+    auto [it, inserted] = symbolIds.emplace(name, pda.inputNames.size());
+    if (inserted)
+      pda.inputNames.push_back(name);
+    return it->second;
+  };
+
+  // Lexer: <name ...> pushes, </name> pops, <name .../> is read without
+  // touching the stack (so it shows up in the trace in input order).
+  for (size_t lt = input.find('<'); lt != std::string::npos;
+       lt = input.find('<', lt + 1)) {
+    size_t gt = input.find('>', lt);
+    if (gt == std::string::npos)
+      break;
+    bool isClose = lt + 1 < gt && input[lt + 1] == '/';
+    size_t nameStart = lt + (isClose ? 2 : 1);
+    size_t nameEnd = nameStart;
+    while (nameEnd < gt && !isspace(input[nameEnd]) && input[nameEnd] != '/')
+      nameEnd++;
+    if (nameEnd == nameStart)
+      continue;
+
+    if (input[gt - 1] == '/') {
+      size_t before = symbolIds.size();
+      int symbol = symbolFor(input.substr(lt, gt - lt + 1));
+      if (symbolIds.size() != before)
+        pda.addTransition(0, symbol, P::ANY, 0, false);
+      symbols.push_back(symbol);
+      lt = gt;
+      continue;
+    }
+
+    std::string name = input.substr(nameStart, nameEnd - nameStart);
+    auto [it, inserted] = tagIds.emplace(name, tagIds.size());
+    int id = it->second;
+    int open = symbolFor("<" + name + ">");
+    int close = symbolFor("</" + name + ">");
+    if (inserted) {
+      pda.stackNames.push_back(name);
+      pda.addTransition(0, open, P::ANY, 0, false, {id});
+      pda.addTransition(0, close, id, 0, true);
+    }
+    symbols.push_back(isClose ? close : open);
+    lt = gt;
+  }
+
+  P::Result result = pda.run(symbols, &log);
+  if (symbols.empty())
+    log.push_back("Warning: No valid tags found in XML mode.");
+  if (!result.accepted && result.position < symbols.size()) {
+    if (result.top == P::EMPTY)
+      log.push_back("Error: Closing tag with Empty Stack");
+    else
+      log.push_back("Error: Mismatch, expected </" +
+                    pda.stackNames[result.top] + ">");
+  }
+  return result.accepted;
 }
 
 } // namespace FormalSystem
@@ -0,0 +1,154 @@
+#include "RNAFolding.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace FormalSystem {
+
+NussinovFolder::NussinovFolder() : NussinovFolder(Options()) {}
+
+NussinovFolder::NussinovFolder(Options options) : options(options) {
+  if (options.minLoop < 0 || options.blockSize < 1)
+    throw std::runtime_error("Invalid folding options");
+}
+
+int NussinovFolder::pairScore(char a, char b) const {
+  if (a > b)
+    std::swap(a, b);
+  if (a == 'C' && b == 'G')
+    return options.weighted ? 3 : 1;
+  if (a == 'A' && b == 'U')
+    return options.weighted ? 2 : 1;
+  if (a == 'G' && b == 'U' && options.wobble)
+    return 1;
+  return 0;
+}
+
+NussinovFolder::Result NussinovFolder::fold(const std::string &sequence) const {
+  size_t n = sequence.size();
+  if (n > MAX_LENGTH)
+    throw std::runtime_error("Sequence too long to fold (max " +
+                             std::to_string(MAX_LENGTH) + " bases)");
+  if (n == 0)
+    return {"", 0, 0};
+
+  std::string s(n, 'N');
+  for (size_t i = 0; i < n; ++i) {
+    char c = std::toupper(static_cast<unsigned char>(sequence[i]));
+    s[i] = c == 'T' ? 'U' : c;
+  }
+
+  // best[i * n + j] = optimal score of s[i..j]; colMajor holds the transpose
+  // so the bifurcation max over k reads two contiguous ranges
+  std::vector<int16_t> best(n * n, 0);
+  std::vector<int16_t> colMajor(n * n, 0);
+  int minLoop = options.minLoop;
+
+  auto cell = [&](size_t i, size_t j) {
+    const int16_t *row = &best[i * n];
+    const int16_t *col = &colMajor[j * n]; // col[k] = best[k][j]
+    int value = std::max(best[(i + 1) * n + j], row[j - 1]);
+    if (static_cast<int>(j - i) > minLoop) {
+      int w = pairScore(s[i], s[j]);
+      if (w > 0)
+        value = std::max(value, best[(i + 1) * n + j - 1] + w);
+    }
+    // Bifurcation: max over k of best[i][k] + best[k + 1][j]. Independent
+    // lanes break the dependency chain and map onto two SIMD registers.
+    int16_t lanes[16] = {};
+    size_t k = i + 1;
+    for (; k + 16 < j; k += 16) {
+      for (int l = 0; l < 16; ++l) {
+        int16_t sum = row[k + l] + col[k + l + 1];
+        lanes[l] = sum > lanes[l] ? sum : lanes[l];
+      }
+    }
+    for (; k + 1 < j; ++k)
+      value = std::max(value, row[k] + col[k + 1]);
+    for (int16_t lane : lanes)
+      value = std::max<int>(value, lane);
+    best[i * n + j] = colMajor[j * n + i] = value;
+  };
+
+  // Within a block: rows bottom-up, columns left to right. Cells to the left
+  // and below in other blocks belong to earlier block diagonals.
+  size_t B = options.blockSize;
+  size_t blocks = (n + B - 1) / B;
+  auto fillBlock = [&](size_t bi, size_t bj) {
+    size_t rowEnd = std::min(n, (bi + 1) * B);
+    size_t colEnd = std::min(n, (bj + 1) * B);
+    for (size_t i = rowEnd; i-- > bi * B;) {
+      for (size_t j = std::max(bj * B, i + 1); j < colEnd; ++j)
+        cell(i, j);
+    }
+  };
+
+  size_t threads = options.threads > 0 ? options.threads
+                                       : std::thread::hardware_concurrency();
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+  threads = 1; // No std::thread without a pthreads build
+#endif
+  threads = std::max<size_t>(threads, 1);
+
+  for (size_t d = 0; d < blocks; ++d) {
+    size_t count = blocks - d;
+    size_t workers = std::min(threads, count);
+    if (workers == 1 || count * B * B < 16384) {
+      for (size_t bi = 0; bi < count; ++bi)
+        fillBlock(bi, bi + d);
+      continue;
+    }
+    std::atomic<size_t> nextBlock{0};
+    auto work = [&]() {
+      for (size_t bi; (bi = nextBlock++) < count;)
+        fillBlock(bi, bi + d);
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < workers; ++t)
+      pool.emplace_back(work);
+    work();
+    for (auto &t : pool)
+      t.join();
+  }
+
+  // Traceback with an explicit stack of intervals
+  Result result{std::string(n, '.'), best[n - 1], 0};
+  std::vector<std::pair<size_t, size_t>> stack = {{0, n - 1}};
+  while (!stack.empty()) {
+    auto [i, j] = stack.back();
+    stack.pop_back();
+    if (i >= j)
+      continue;
+    int value = best[i * n + j];
+    if (value == best[(i + 1) * n + j]) {
+      stack.push_back({i + 1, j});
+      continue;
+    }
+    if (value == best[i * n + j - 1]) {
+      stack.push_back({i, j - 1});
+      continue;
+    }
+    int w = static_cast<int>(j - i) > minLoop ? pairScore(s[i], s[j]) : 0;
+    if (w > 0 && value == best[(i + 1) * n + j - 1] + w) {
+      result.structure[i] = '(';
+      result.structure[j] = ')';
+      result.pairs++;
+      stack.push_back({i + 1, j - 1});
+      continue;
+    }
+    for (size_t k = i + 1; k + 1 < j; ++k) {
+      if (value == best[i * n + k] + best[(k + 1) * n + j]) {
+        stack.push_back({i, k});
+        stack.push_back({k + 1, j});
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+} // namespace FormalSystem
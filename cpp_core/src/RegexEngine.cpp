@@ -1,4 +1,5 @@
 #include "RegexEngine.h"
+#include "Stats.h"
 #include <algorithm>
 #include <iostream>
 #include <map>
@@ -6,13 +7,17 @@
 #include <set>
 #include <stack>
 #include <stdexcept>
+#include <unordered_map>
 #include <vector>
 
 namespace FormalSystem {
 
 // Helper to generate unique state IDs
 static int stateCounter = 0;
-static int generateStateId() { return stateCounter++; }
+static int generateStateId() {
+  FS_STAT_ADD(nfaStates, 1);
+  return stateCounter++;
+}
 
 static void resetStateCounter() { stateCounter = 0; }
 
@@ -27,22 +32,34 @@ std::string RegexEngine::preprocessRegex(const std::string &regex) {
   std::string result;
   for (size_t i = 0; i < regex.length(); ++i) {
     char c1 = regex[i];
-    result += c1;
+    if (c1 == '[') {
+      // Class placeholder "[k]" (see extractClasses) is one operand
+      size_t close = regex.find(']', i);
+      result += regex.substr(i, close - i + 1);
+      i = close;
+      c1 = ']';
+    } else if (c1 == '{') {
+      // Repetition bounds are copied verbatim and act like a postfix operator
+      size_t close = regex.find('}', i);
+      if (close == std::string::npos)
+        throw std::runtime_error("Invalid regex: missing '}' in repetition");
+      result += regex.substr(i, close - i + 1);
+      i = close;
+      c1 = '}';
+    } else {
+      result += c1;
+    }
 
     if (i + 1 < regex.length()) {
       char c2 = regex[i + 1];
       // Add '.' if:
       // 1. c1 is NOT '(' or '|'
-      // 2. c2 is NOT ')' or '|' or '*'
+      // 2. c2 is NOT ')' or '|' or '*' or '{'
       bool c1_is_operand = (c1 != '(' && c1 != '|');
-      bool c2_is_operand = (c2 != ')' && c2 != '|' && c2 != '*');
+      bool c2_is_operand = (c2 != ')' && c2 != '|' && c2 != '*' && c2 != '{');
 
       if (c1_is_operand && c2_is_operand) {
         result += '.';
-      } else if (c1 == '*' && c2_is_operand) {
-        result += '.';
-      } else if (c1 == ')' && c2_is_operand) {
-        result += '.';
       }
     }
   }
@@ -62,13 +79,24 @@ int RegexEngine::getPrecedence(char c) {
 std::string RegexEngine::toPostfix(const std::string &regex) {
   std::string postfix;
   std::stack<char> operators;
+  std::stack<int> groups; // Capture group number of each open '('
+  int groupCount = 0;
   std::string processed = preprocessRegex(regex);
 
-  for (char c : processed) {
+  for (size_t i = 0; i < processed.size(); ++i) {
+    char c = processed[i];
     if (isalnum(c)) {
       postfix += c;
+    } else if (c == '*') {
+      // Unary operators bind tightest, so they go straight to the output
+      postfix += c;
+    } else if (c == '{' || c == '[') {
+      size_t close = processed.find(c == '{' ? '}' : ']', i);
+      postfix += processed.substr(i, close - i + 1);
+      i = close;
     } else if (c == '(') {
       operators.push(c);
+      groups.push(++groupCount);
     } else if (c == ')') {
       while (!operators.empty() && operators.top() != '(') {
         postfix += operators.top();
@@ -78,6 +106,10 @@ std::string RegexEngine::toPostfix(const std::string &regex) {
         throw std::runtime_error("Mismatched parentheses: Missing '('");
       }
       operators.pop(); // Pop '('
+
+      // Group marker "(n)" acts like a unary operator on the group body
+      postfix += "(" + std::to_string(groups.top()) + ")";
+      groups.pop();
     } else {
       while (!operators.empty() &&
              getPrecedence(operators.top()) >= getPrecedence(c)) {
@@ -98,26 +130,363 @@ std::string RegexEngine::toPostfix(const std::string &regex) {
   return postfix;
 }
 
+// Parses the body of "{m}", "{m,}" or "{m,n}" (without braces)
+static RegexToken parseRepeat(const std::string &bounds) {
+  RegexToken token{RegexToken::Repeat};
+  size_t comma = bounds.find(',');
+  std::string lo = bounds.substr(0, comma);
+  std::string hi =
+      comma == std::string::npos ? lo : bounds.substr(comma + 1);
+
+  auto isNumber = [](const std::string &s) {
+    return !s.empty() && s.size() <= 9 &&
+           std::all_of(s.begin(), s.end(), ::isdigit);
+  };
+  if (!(lo.empty() && comma != std::string::npos) && !isNumber(lo))
+    throw std::runtime_error("Invalid regex: bad repetition {" + bounds + "}");
+  if (!hi.empty() && !isNumber(hi))
+    throw std::runtime_error("Invalid regex: bad repetition {" + bounds + "}");
+
+  token.min = lo.empty() ? 0 : std::stoi(lo);
+  token.max = hi.empty() ? -1 : std::stoi(hi);
+  if (token.max != -1 && token.max < token.min)
+    throw std::runtime_error("Invalid regex: repetition {" + bounds +
+                             "} has max < min");
+  return token;
+}
+
+// ====================== Unicode Classes ======================
+
+// Reads the escape at regex[i] ('\\') and advances i past it
+static uint32_t parseEscape(const std::string &regex, size_t &i) {
+  if (i + 1 >= regex.size())
+    throw std::runtime_error("Invalid regex: trailing '\\'");
+  char c = regex[i + 1];
+  i += 2;
+  if (c == 'n')
+    return '\n';
+  if (c == 't')
+    return '\t';
+  if (c == 'r')
+    return '\r';
+  if (c != 'u') {
+    if (!ispunct(static_cast<unsigned char>(c)))
+      throw std::runtime_error(std::string("Invalid regex: unknown escape \\") +
+                               c);
+    return static_cast<unsigned char>(c);
+  }
+
+  // \u{1-6 hex digits} or \uXXXX
+  bool braced = i < regex.size() && regex[i] == '{';
+  size_t begin = braced ? i + 1 : i;
+  size_t end = braced ? regex.find('}', begin) : begin + 4;
+  if (end == std::string::npos || end > regex.size() || end == begin ||
+      end - begin > 6 ||
+      !std::all_of(regex.begin() + begin, regex.begin() + end, ::isxdigit))
+    throw std::runtime_error("Invalid regex: bad \\u escape");
+  uint32_t codepoint =
+      std::stoul(regex.substr(begin, end - begin), nullptr, 16);
+  if (codepoint > CodepointSet::MAX_CODEPOINT ||
+      (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+    throw std::runtime_error("Invalid regex: \\u escape is not a codepoint");
+  i = braced ? end + 1 : end;
+  return codepoint;
+}
+
+// One codepoint (escape, UTF-8 sequence or ASCII byte) at regex[i]
+static uint32_t parseCodepoint(const std::string &regex, size_t &i) {
+  if (regex[i] == '\\')
+    return parseEscape(regex, i);
+  if (static_cast<unsigned char>(regex[i]) >= 0x80)
+    return decodeUtf8(regex, i);
+  return static_cast<unsigned char>(regex[i++]);
+}
+
+// Parses "[...]" or "[^...]" at regex[i] and advances i past the ']'
+static CodepointSet parseClass(const std::string &regex, size_t &i) {
+  CodepointSet set;
+  bool negated = ++i < regex.size() && regex[i] == '^';
+  if (negated)
+    ++i;
+  bool empty = true;
+  while (i < regex.size() && regex[i] != ']') {
+    uint32_t lo = parseCodepoint(regex, i);
+    uint32_t hi = lo;
+    if (i + 1 < regex.size() && regex[i] == '-' && regex[i + 1] != ']') {
+      ++i;
+      hi = parseCodepoint(regex, i);
+      if (hi < lo)
+        throw std::runtime_error("Invalid regex: class range out of order");
+    }
+    set.add(lo, hi);
+    empty = false;
+  }
+  if (i >= regex.size())
+    throw std::runtime_error("Invalid regex: missing ']' in class");
+  if (empty)
+    throw std::runtime_error("Invalid regex: empty character class");
+  ++i;
+  if (negated)
+    set.negate();
+  return set;
+}
+
+// Replaces classes, escapes and non-ASCII characters with placeholders
+// "[k]" for classes[k]. Escaped alphanumerics stay plain literals.
+static std::string extractClasses(const std::string &regex,
+                                  std::vector<CodepointSet> &classes) {
+  std::string result;
+  for (size_t i = 0; i < regex.size();) {
+    unsigned char c = regex[i];
+    CodepointSet set;
+    if (c == '[') {
+      set = parseClass(regex, i);
+    } else if (c == ']') {
+      throw std::runtime_error("Invalid regex: unmatched ']'");
+    } else if (c == '\\' || c >= 0x80) {
+      uint32_t codepoint = parseCodepoint(regex, i);
+      if (codepoint < 0x80 && isalnum(codepoint)) {
+        result += static_cast<char>(codepoint);
+        continue;
+      }
+      set.add(codepoint);
+    } else {
+      result += regex[i++];
+      continue;
+    }
+    result += "[" + std::to_string(classes.size()) + "]";
+    classes.push_back(set);
+  }
+  return result;
+}
+
+std::vector<RegexToken> RegexEngine::toPostfixTokens(const std::string &regex) {
+  std::vector<CodepointSet> classes;
+  std::string postfix = toPostfix(extractClasses(regex, classes));
+  std::vector<RegexToken> tokens;
+
+  for (size_t i = 0; i < postfix.size(); ++i) {
+    char c = postfix[i];
+    if (isalnum(c)) {
+      RegexToken token{RegexToken::Literal};
+      token.symbol = c;
+      tokens.push_back(token);
+    } else if (c == '.') {
+      tokens.push_back({RegexToken::Concat});
+    } else if (c == '|') {
+      tokens.push_back({RegexToken::Union});
+    } else if (c == '*') {
+      tokens.push_back({RegexToken::Star});
+    } else if (c == '{') {
+      size_t close = postfix.find('}', i);
+      tokens.push_back(parseRepeat(postfix.substr(i + 1, close - i - 1)));
+      i = close;
+    } else if (c == '[') {
+      size_t close = postfix.find(']', i);
+      RegexToken token{RegexToken::Class};
+      const CodepointSet &set =
+          classes[std::stoi(postfix.substr(i + 1, close - i - 1))];
+      token.bytes =
+          std::make_shared<const Utf8Automaton>(Utf8Automaton::compile(set));
+      tokens.push_back(token);
+      i = close;
+    } else if (c == '(') {
+      size_t close = postfix.find(')', i);
+      RegexToken token{RegexToken::Group};
+      token.group = std::stoi(postfix.substr(i + 1, close - i - 1));
+      tokens.push_back(token);
+      i = close;
+    }
+  }
+  return tokens;
+}
+
 // ====================== Thompson's Construction ======================
 
+// Single edge start --symbol--> end
+static NFA symbolNFA(char c) {
+  NFA nfa;
+  auto start = std::make_shared<State>(generateStateId());
+  auto end = std::make_shared<State>(generateStateId(), true);
+  nfa.addState(start);
+  nfa.addState(end);
+  nfa.addTransition(start, c, end);
+  nfa.startState = start;
+  return nfa;
+}
+
+// Character class: one state per byte-automaton node, node 0 final
+static NFA utf8NFA(const Utf8Automaton &bytes) {
+  NFA nfa;
+  std::vector<std::shared_ptr<State>> states;
+  for (size_t id = 0; id < bytes.nodes.size(); ++id) {
+    states.push_back(std::make_shared<State>(generateStateId(), id == 0));
+    nfa.addState(states.back());
+  }
+  for (size_t id = 1; id < bytes.nodes.size(); ++id) {
+    for (const auto &e : bytes.nodes[id]) {
+      for (int b = e.lo; b <= e.hi; ++b)
+        nfa.addTransition(states[id], static_cast<char>(b), states[e.target]);
+    }
+  }
+  nfa.startState = states[bytes.start()];
+  return nfa;
+}
+
+// Accepts only the empty string
+static NFA epsilonNFA() {
+  NFA nfa;
+  auto start = std::make_shared<State>(generateStateId());
+  auto end = std::make_shared<State>(generateStateId(), true);
+  nfa.addState(start);
+  nfa.addState(end);
+  nfa.addEpsilonTransition(start, end);
+  nfa.startState = start;
+  return nfa;
+}
+
+static NFA concatNFA(NFA left, const NFA &right) {
+  // Connect left's final states to right's start state via epsilon
+  for (auto &finalState : left.finalStates) {
+    finalState->isFinal = false;
+    left.addEpsilonTransition(finalState, right.startState);
+  }
+
+  // Merge states
+  left.allStates.insert(left.allStates.end(), right.allStates.begin(),
+                        right.allStates.end());
+  left.finalStates = right.finalStates;
+  left.alphabet.insert(right.alphabet.begin(), right.alphabet.end());
+  return left;
+}
+
+static NFA unionNFA(NFA top, NFA bottom) {
+  NFA result;
+  auto start = std::make_shared<State>(generateStateId());
+  auto end = std::make_shared<State>(generateStateId(), true);
+  result.addState(start);
+  result.addState(end);
+
+  // Connect new start to both starts
+  result.addEpsilonTransition(start, top.startState);
+  result.addEpsilonTransition(start, bottom.startState);
+
+  // Connect both finals to new end
+  for (auto &s : top.finalStates) {
+    s->isFinal = false;
+    top.addEpsilonTransition(s, end);
+  }
+  for (auto &s : bottom.finalStates) {
+    s->isFinal = false;
+    bottom.addEpsilonTransition(s, end);
+  }
+
+  // Merge all
+  result.allStates.insert(result.allStates.end(), top.allStates.begin(),
+                          top.allStates.end());
+  result.allStates.insert(result.allStates.end(), bottom.allStates.begin(),
+                          bottom.allStates.end());
+  result.alphabet.insert(top.alphabet.begin(), top.alphabet.end());
+  result.alphabet.insert(bottom.alphabet.begin(), bottom.alphabet.end());
+  result.startState = start;
+  return result;
+}
+
+// Kleene star (loop = true) or optional (loop = false)
+static NFA starNFA(NFA inner, bool loop = true) {
+  NFA result;
+  auto start = std::make_shared<State>(generateStateId());
+  auto end = std::make_shared<State>(generateStateId(), true);
+  result.addState(start);
+  result.addState(end);
+
+  // Epsilon from new start to inner start
+  result.addEpsilonTransition(start, inner.startState);
+  // Epsilon from new start to new end (0 occurrences)
+  result.addEpsilonTransition(start, end);
+
+  // Epsilon from inner finals to inner start (loop)
+  // Epsilon from inner finals to new end
+  for (auto &s : inner.finalStates) {
+    s->isFinal = false;
+    if (loop)
+      inner.addEpsilonTransition(s, inner.startState);
+    inner.addEpsilonTransition(s, end);
+  }
+
+  result.allStates.insert(result.allStates.end(), inner.allStates.begin(),
+                          inner.allStates.end());
+  result.alphabet = inner.alphabet;
+  result.startState = start;
+  return result;
+}
+
+// Deep copy of a fragment with fresh state IDs
+static NFA cloneNFA(const NFA &src) {
+  NFA copy;
+  std::unordered_map<const State *, std::shared_ptr<State>> mapping;
+  for (const auto &s : src.allStates) {
+    auto c = std::make_shared<State>(generateStateId(), s->isFinal);
+    mapping[s.get()] = c;
+    copy.addState(c);
+  }
+  for (const auto &s : src.allStates) {
+    auto &c = mapping.at(s.get());
+    for (const auto &[symbol, nextStates] : s->transitions) {
+      for (const auto &next : nextStates)
+        c->transitions[symbol].push_back(mapping.at(next.get()));
+    }
+    for (const auto &next : s->epsilonTransitions)
+      c->epsilonTransitions.push_back(mapping.at(next.get()));
+  }
+  copy.startState = mapping.at(src.startState.get());
+  copy.alphabet = src.alphabet;
+  return copy;
+}
+
+// r{min,max} expanded by copying: r...r (r(r...)?)? or r...r r*
+static NFA repeatNFA(const NFA &inner, int min, int max) {
+  long copies = max == -1 ? min + 1L : max;
+  if (copies * static_cast<long>(inner.allStates.size() + 2) >
+      RegexEngine::MAX_EXPANDED_STATES) {
+    throw std::runtime_error(
+        "Bounded repetition too large to expand; use the counting automaton");
+  }
+
+  std::vector<NFA> parts;
+  for (int i = 0; i < min; ++i)
+    parts.push_back(cloneNFA(inner));
+
+  if (max == -1) {
+    parts.push_back(starNFA(cloneNFA(inner)));
+  } else if (max > min) {
+    NFA tail = starNFA(cloneNFA(inner), false);
+    for (int i = min + 1; i < max; ++i)
+      tail = starNFA(concatNFA(cloneNFA(inner), tail), false);
+    parts.push_back(tail);
+  }
+
+  if (parts.empty())
+    return epsilonNFA();
+  NFA result = parts[0];
+  for (size_t i = 1; i < parts.size(); ++i)
+    result = concatNFA(result, parts[i]);
+  return result;
+}
+
 NFA RegexEngine::regexToNFA(const std::string &regex) {
+  FS_STAT_PHASE(Parse);
   resetStateCounter();
-  std::string postfix = toPostfix(regex);
+  std::vector<RegexToken> tokens = toPostfixTokens(regex);
   std::stack<NFA> stack;
 
-  for (char c : postfix) {
-    if (isalnum(c)) {
+  for (const auto &token : tokens) {
+    if (token.type == RegexToken::Literal) {
       // Base case: Single character transition
-      NFA nfa;
-      auto start = std::make_shared<State>(generateStateId());
-      auto end = std::make_shared<State>(generateStateId(), true);
-      nfa.addState(start);
-      nfa.addState(end);
-      nfa.addTransition(start, c, end);
-      nfa.startState = start;
-      nfa.finalStates.insert(end);
-      stack.push(nfa);
-    } else if (c == '.') {
+      stack.push(symbolNFA(token.symbol));
+    } else if (token.type == RegexToken::Class) {
+      stack.push(utf8NFA(*token.bytes));
+    } else if (token.type == RegexToken::Concat) {
       // Concatenation
       if (stack.size() < 2)
         throw std::runtime_error(
@@ -126,22 +495,9 @@ NFA RegexEngine::regexToNFA(const std::string &regex) {
       stack.pop();
       NFA left = stack.top();
       stack.pop();
+      stack.push(concatNFA(left, right));
 
-      // Connect left's final states to right's start state via epsilon
-      for (auto &finalState : left.finalStates) {
-        finalState->isFinal = false;
-        left.addEpsilonTransition(finalState, right.startState);
-      }
-
-      // Merge states
-      left.allStates.insert(left.allStates.end(), right.allStates.begin(),
-                            right.allStates.end());
-      left.finalStates = right.finalStates;
-      left.alphabet.insert(right.alphabet.begin(), right.alphabet.end());
-
-      stack.push(left);
-
-    } else if (c == '|') {
+    } else if (token.type == RegexToken::Union) {
       // Union
       if (stack.size() < 2)
         throw std::runtime_error("Invalid regex: union '|' missing operands");
@@ -149,73 +505,25 @@ NFA RegexEngine::regexToNFA(const std::string &regex) {
       stack.pop();
       NFA top = stack.top();
       stack.pop();
+      stack.push(unionNFA(top, bottom));
 
-      NFA result;
-      auto start = std::make_shared<State>(generateStateId());
-      auto end = std::make_shared<State>(generateStateId(), true);
-      result.addState(start);
-      result.addState(end);
-
-      // Connect new start to both starts
-      result.addEpsilonTransition(start, top.startState);
-      result.addEpsilonTransition(start, bottom.startState);
-
-      // Connect both finals to new end
-      for (auto &s : top.finalStates) {
-        s->isFinal = false;
-        top.addEpsilonTransition(s, end);
-      }
-      for (auto &s : bottom.finalStates) {
-        s->isFinal = false;
-        bottom.addEpsilonTransition(s, end);
-      }
-
-      // Merge all
-      result.allStates.insert(result.allStates.end(), top.allStates.begin(),
-                              top.allStates.end());
-      result.allStates.insert(result.allStates.end(), bottom.allStates.begin(),
-                              bottom.allStates.end());
-      result.alphabet.insert(top.alphabet.begin(), top.alphabet.end());
-      result.alphabet.insert(bottom.alphabet.begin(), bottom.alphabet.end());
-      result.finalStates.insert(end);
-      result.startState = start;
-
-      stack.push(result);
-
-    } else if (c == '*') {
+    } else if (token.type == RegexToken::Star) {
       // Kleene Star
       if (stack.empty())
         throw std::runtime_error("Invalid regex: '*' missing operand");
       NFA inner = stack.top();
       stack.pop();
+      stack.push(starNFA(inner));
 
-      NFA result;
-      auto start = std::make_shared<State>(generateStateId());
-      auto end = std::make_shared<State>(generateStateId(), true);
-      result.addState(start);
-      result.addState(end);
-
-      // Epsilon from new start to inner start
-      result.addEpsilonTransition(start, inner.startState);
-      // Epsilon from new start to new end (0 occurrences)
-      result.addEpsilonTransition(start, end);
-
-      // Epsilon from inner finals to inner start (loop)
-      // Epsilon from inner finals to new end
-      for (auto &s : inner.finalStates) {
-        s->isFinal = false;
-        inner.addEpsilonTransition(s, inner.startState);
-        inner.addEpsilonTransition(s, end);
-      }
-
-      result.allStates.insert(result.allStates.end(), inner.allStates.begin(),
-                              inner.allStates.end());
-      result.alphabet = inner.alphabet;
-      result.finalStates.insert(end);
-      result.startState = start;
-
-      stack.push(result);
+    } else if (token.type == RegexToken::Repeat) {
+      // Bounded repetition
+      if (stack.empty())
+        throw std::runtime_error("Invalid regex: '{' missing operand");
+      NFA inner = stack.top();
+      stack.pop();
+      stack.push(repeatNFA(inner, token.min, token.max));
     }
+    // Group markers only matter for capture extraction
   }
 
   if (stack.empty())
@@ -276,6 +584,7 @@ NFA RegexEngine::regexToNFA(const std::string &regex) {
 // ====================== Subset Construction ======================
 
 DFA RegexEngine::nfaToDFA(const NFA &nfa) {
+  FS_STAT_PHASE(Determinize);
   DFA dfa;
   dfa.alphabet = nfa.alphabet;
 
@@ -303,6 +612,7 @@ DFA RegexEngine::nfaToDFA(const NFA &nfa) {
   // it static helper. For now, I'll implement a local helper.
 
   auto epsilonClosure = [](std::set<std::shared_ptr<State>> &states) {
+    FS_STAT_ADD(closureCalls, 1);
     std::queue<std::shared_ptr<State>> q;
     for (auto s : states)
       q.push(s);
@@ -313,6 +623,7 @@ DFA RegexEngine::nfaToDFA(const NFA &nfa) {
         if (states.find(next) == states.end()) {
           states.insert(next);
           q.push(next);
+          FS_STAT_ADD(closureStates, 1);
         }
       }
     }
@@ -324,6 +635,7 @@ DFA RegexEngine::nfaToDFA(const NFA &nfa) {
   dfaStateMap[getSetKey(startSet)] = dfaIdCounter;
   dfa.startStateId = dfaIdCounter;
   dfa.states[dfaIdCounter] = {dfaIdCounter, false, {}};
+  FS_STAT_ADD(dfaStates, 1);
 
   // Check if start state is final
   for (auto s : startSet) {
@@ -360,6 +672,7 @@ DFA RegexEngine::nfaToDFA(const NFA &nfa) {
       if (dfaStateMap.find(key) == dfaStateMap.end()) {
         dfaStateMap[key] = dfaIdCounter;
         dfa.states[dfaIdCounter] = {dfaIdCounter, false, {}};
+        FS_STAT_ADD(dfaStates, 1);
 
         for (auto s : nextSet) {
           if (s->isFinal) {
@@ -380,4 +693,338 @@ DFA RegexEngine::nfaToDFA(const NFA &nfa) {
   return dfa;
 }
 
+// ====================== Counting Construction ======================
+
+// Fragment of a node-based automaton (CountingNFA, CaptureNFA) under
+// construction: nodes [first, end) plus the dangling exits that still need a
+// target (node ID, slot 0 = out, 1 = out1)
+struct NodeFragment {
+  int start;
+  int first;
+  std::vector<std::pair<int, int>> exits;
+};
+
+template <typename Program>
+static void patch(Program &nfa, const NodeFragment &frag, int target) {
+  for (const auto &[node, slot] : frag.exits) {
+    if (slot == 0)
+      nfa.nodes[node].out = target;
+    else
+      nfa.nodes[node].out1 = target;
+  }
+}
+
+template <typename Program>
+static int addNode(Program &nfa, typename Program::Node::Kind kind) {
+  typename Program::Node node{kind};
+  nfa.nodes.push_back(node);
+  return nfa.nodes.size() - 1;
+}
+
+// Character class as Char nodes: each byte-automaton node becomes a chain of
+// Splits over its bytes (children first, so targets already exist), and the
+// bytes into the accepting node are the fragment's exits
+template <typename Program>
+static NodeFragment utf8Fragment(Program &nfa, const Utf8Automaton &bytes) {
+  using Node = typename Program::Node;
+  int first = nfa.nodes.size();
+  std::vector<int> entry(bytes.nodes.size(), -1);
+  std::vector<std::pair<int, int>> exits;
+  for (size_t id = 1; id < bytes.nodes.size(); ++id) {
+    std::vector<int> chars;
+    for (const auto &e : bytes.nodes[id]) {
+      for (int b = e.lo; b <= e.hi; ++b) {
+        int c = addNode(nfa, Node::Char);
+        nfa.nodes[c].symbol = static_cast<char>(b);
+        nfa.alphabet.insert(static_cast<char>(b));
+        if (e.target == 0)
+          exits.push_back({c, 0});
+        else
+          nfa.nodes[c].out = entry[e.target];
+        chars.push_back(c);
+      }
+    }
+    int next = chars.back();
+    for (size_t k = chars.size() - 1; k-- > 0;) {
+      int split = addNode(nfa, Node::Split);
+      nfa.nodes[split].out = chars[k];
+      nfa.nodes[split].out1 = next;
+      next = split;
+    }
+    entry[id] = next;
+  }
+  return {entry[bytes.start()], first, exits};
+}
+
+CountingNFA RegexEngine::regexToCountingNFA(const std::string &regex) {
+  using Node = CountingNFA::Node;
+  std::vector<RegexToken> tokens = toPostfixTokens(regex);
+  CountingNFA nfa;
+  std::stack<NodeFragment> stack;
+
+  for (const auto &token : tokens) {
+    if (token.type == RegexToken::Literal) {
+      int id = addNode(nfa, Node::Char);
+      nfa.nodes[id].symbol = token.symbol;
+      nfa.alphabet.insert(token.symbol);
+      stack.push({id, id, {{id, 0}}});
+
+    } else if (token.type == RegexToken::Class) {
+      stack.push(utf8Fragment(nfa, *token.bytes));
+
+    } else if (token.type == RegexToken::Concat) {
+      if (stack.size() < 2)
+        throw std::runtime_error(
+            "Invalid regex: concatenation missing operands");
+      NodeFragment right = stack.top();
+      stack.pop();
+      NodeFragment left = stack.top();
+      stack.pop();
+      patch(nfa, left, right.start);
+      stack.push({left.start, left.first, right.exits});
+
+    } else if (token.type == RegexToken::Union) {
+      if (stack.size() < 2)
+        throw std::runtime_error("Invalid regex: union '|' missing operands");
+      NodeFragment bottom = stack.top();
+      stack.pop();
+      NodeFragment top = stack.top();
+      stack.pop();
+      int id = addNode(nfa, Node::Split);
+      nfa.nodes[id].out = top.start;
+      nfa.nodes[id].out1 = bottom.start;
+      top.exits.insert(top.exits.end(), bottom.exits.begin(),
+                       bottom.exits.end());
+      stack.push({id, top.first, top.exits});
+
+    } else if (token.type == RegexToken::Star) {
+      if (stack.empty())
+        throw std::runtime_error("Invalid regex: '*' missing operand");
+      NodeFragment inner = stack.top();
+      stack.pop();
+      int id = addNode(nfa, Node::Split);
+      nfa.nodes[id].out = inner.start;
+      patch(nfa, inner, id);
+      stack.push({id, inner.first, {{id, 1}}});
+
+    } else if (token.type == RegexToken::Repeat) {
+      if (stack.empty())
+        throw std::runtime_error("Invalid regex: '{' missing operand");
+      NodeFragment inner = stack.top();
+      stack.pop();
+
+      if (token.max == 0) {
+        // r{0} matches only the empty string
+        int id = addNode(nfa, Node::Split);
+        stack.push({id, inner.first, {{id, 0}, {id, 1}}});
+        continue;
+      }
+
+      int counter = nfa.counters.size();
+      for (size_t i = inner.first; i < nfa.nodes.size(); ++i) {
+        if (nfa.nodes[i].scope != -1)
+          throw std::runtime_error(
+              "Nested bounded repetitions are not supported in counting mode");
+        nfa.nodes[i].scope = counter;
+      }
+      // r{0,n} is (r{1,n})?, so counters always start at 1
+      nfa.counters.push_back({std::max(token.min, 1), token.max});
+
+      int loop = addNode(nfa, Node::Loop);
+      nfa.nodes[loop].counter = counter;
+      nfa.nodes[loop].scope = counter;
+      nfa.nodes[loop].out = inner.start;
+      patch(nfa, inner, loop);
+
+      int enter = addNode(nfa, Node::Enter);
+      nfa.nodes[enter].counter = counter;
+      nfa.nodes[enter].out = inner.start;
+
+      if (token.min == 0) {
+        int skip = addNode(nfa, Node::Split);
+        nfa.nodes[skip].out = enter;
+        stack.push({skip, inner.first, {{loop, 1}, {skip, 1}}});
+      } else {
+        stack.push({enter, inner.first, {{loop, 1}}});
+      }
+    }
+    // Group markers only matter for capture extraction
+  }
+
+  if (stack.empty())
+    return nfa;
+  if (stack.size() > 1)
+    throw std::runtime_error("Invalid regex: missing operator");
+
+  int match = addNode(nfa, Node::Match);
+  patch(nfa, stack.top(), match);
+  nfa.start = stack.top().start;
+  return nfa;
+}
+
+// ====================== Capture Construction ======================
+
+// Copies the nodes [frag.first, end) of a fragment and returns the relocated
+// copy. Edges leaving that range (none for a fragment still on the stack) and
+// dangling exits keep their targets.
+static NodeFragment cloneFragment(CaptureNFA &nfa, const NodeFragment &frag,
+                                  int end) {
+  int offset = nfa.nodes.size() - frag.first;
+  auto relocate = [&](int id) {
+    return id >= frag.first && id < end ? id + offset : id;
+  };
+
+  for (int id = frag.first; id < end; ++id) {
+    CaptureNFA::Node node = nfa.nodes[id];
+    node.out = relocate(node.out);
+    node.out1 = relocate(node.out1);
+    nfa.nodes.push_back(node);
+  }
+
+  NodeFragment copy{relocate(frag.start), relocate(frag.first), {}};
+  for (const auto &[node, slot] : frag.exits)
+    copy.exits.push_back({relocate(node), slot});
+  return copy;
+}
+
+// Split whose preferred branch enters 'body' and whose other branch skips it;
+// with loop = true the body's exits come back to the split (greedy star)
+static NodeFragment optionalFragment(CaptureNFA &nfa, const NodeFragment &body,
+                                     bool loop) {
+  int id = addNode(nfa, CaptureNFA::Node::Split);
+  nfa.nodes[id].out = body.start;
+  if (loop) {
+    patch(nfa, body, id);
+    return {id, body.first, {{id, 1}}};
+  }
+  NodeFragment frag{id, body.first, body.exits};
+  frag.exits.push_back({id, 1});
+  return frag;
+}
+
+CaptureNFA RegexEngine::regexToCaptureNFA(const std::string &regex) {
+  using Node = CaptureNFA::Node;
+  std::vector<RegexToken> tokens = toPostfixTokens(regex);
+  CaptureNFA nfa;
+  std::stack<NodeFragment> stack;
+
+  auto pop = [&](const char *error) {
+    if (stack.empty())
+      throw std::runtime_error(error);
+    NodeFragment frag = stack.top();
+    stack.pop();
+    return frag;
+  };
+
+  for (const auto &token : tokens) {
+    if (token.type == RegexToken::Literal) {
+      int id = addNode(nfa, Node::Char);
+      nfa.nodes[id].symbol = token.symbol;
+      nfa.alphabet.insert(token.symbol);
+      stack.push({id, id, {{id, 0}}});
+
+    } else if (token.type == RegexToken::Class) {
+      stack.push(utf8Fragment(nfa, *token.bytes));
+
+    } else if (token.type == RegexToken::Concat) {
+      NodeFragment right = pop("Invalid regex: concatenation missing operands");
+      NodeFragment left = pop("Invalid regex: concatenation missing operands");
+      patch(nfa, left, right.start);
+      stack.push({left.start, left.first, right.exits});
+
+    } else if (token.type == RegexToken::Union) {
+      NodeFragment bottom = pop("Invalid regex: union '|' missing operands");
+      NodeFragment top = pop("Invalid regex: union '|' missing operands");
+      int id = addNode(nfa, Node::Split);
+      nfa.nodes[id].out = top.start;
+      nfa.nodes[id].out1 = bottom.start;
+      top.exits.insert(top.exits.end(), bottom.exits.begin(),
+                       bottom.exits.end());
+      stack.push({id, top.first, top.exits});
+
+    } else if (token.type == RegexToken::Star) {
+      NodeFragment inner = pop("Invalid regex: '*' missing operand");
+      stack.push(optionalFragment(nfa, inner, true));
+
+    } else if (token.type == RegexToken::Group) {
+      NodeFragment inner = pop("Invalid regex: empty group");
+      int open = addNode(nfa, Node::Save);
+      nfa.nodes[open].slot = 2 * token.group;
+      nfa.nodes[open].out = inner.start;
+      int close = addNode(nfa, Node::Save);
+      nfa.nodes[close].slot = 2 * token.group + 1;
+      patch(nfa, inner, close);
+      nfa.groupCount = std::max(nfa.groupCount, token.group + 1);
+      stack.push({open, inner.first, {{close, 0}}});
+
+    } else if (token.type == RegexToken::Repeat) {
+      // Expanded by copying, like regexToNFA: r...r (r(r...)?)? or r...r r*
+      NodeFragment inner = pop("Invalid regex: '{' missing operand");
+      int required = token.min;
+      int pieces = token.max == -1 ? token.min + 1 : token.max;
+      int innerEnd = nfa.nodes.size();
+      long size = innerEnd - inner.first + 1;
+      if (pieces * size > MAX_EXPANDED_STATES) {
+        throw std::runtime_error(
+            "Bounded repetition too large to expand for capture matching");
+      }
+
+      if (pieces == 0) {
+        // r{0} matches only the empty string
+        int id = addNode(nfa, Node::Split);
+        stack.push({id, inner.first, {{id, 0}, {id, 1}}});
+        continue;
+      }
+
+      std::vector<NodeFragment> copies = {inner};
+      for (int i = 1; i < pieces; ++i)
+        copies.push_back(cloneFragment(nfa, inner, innerEnd));
+
+      // Optional part: nested (r(r...)?)? for {m,n}, r* for {m,}
+      bool hasTail = pieces > required;
+      NodeFragment tail{};
+      if (hasTail) {
+        tail = optionalFragment(nfa, copies.back(), token.max == -1);
+        for (int i = pieces - 2; i >= required; --i) {
+          patch(nfa, copies[i], tail.start);
+          NodeFragment body{copies[i].start, copies[i].first, tail.exits};
+          tail = optionalFragment(nfa, body, false);
+        }
+      }
+
+      NodeFragment result = required > 0 ? copies[0] : tail;
+      for (int i = 1; i < required; ++i) {
+        patch(nfa, result, copies[i].start);
+        result.exits = copies[i].exits;
+      }
+      if (required > 0 && hasTail) {
+        patch(nfa, result, tail.start);
+        result.exits = tail.exits;
+      }
+      result.first = inner.first;
+      stack.push(result);
+    }
+  }
+
+  if (stack.size() > 1)
+    throw std::runtime_error("Invalid regex: missing operator");
+
+  // Group 0 spans the whole match
+  int open = addNode(nfa, Node::Save);
+  nfa.nodes[open].slot = 0;
+  int close = addNode(nfa, Node::Save);
+  nfa.nodes[close].slot = 1;
+  int match = addNode(nfa, Node::Match);
+  nfa.nodes[close].out = match;
+  if (stack.empty()) {
+    nfa.nodes[open].out = close;
+  } else {
+    nfa.nodes[open].out = stack.top().start;
+    patch(nfa, stack.top(), close);
+  }
+  nfa.start = open;
+  nfa.buildOnePass();
+  return nfa;
+}
+
 } // namespace FormalSystem
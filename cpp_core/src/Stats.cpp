@@ -0,0 +1,53 @@
+#include "Stats.h"
+#include <cstdio>
+
+namespace FormalSystem {
+
+EngineStats &Stats::current() {
+  static thread_local EngineStats stats;
+  return stats;
+}
+
+void Stats::reset() { current() = EngineStats(); }
+
+std::string Stats::report() {
+  if (!enabled)
+    return "Statistics are disabled in this build (rebuild with make "
+           "STATS=1).\n";
+
+  const EngineStats &s = current();
+  struct Row {
+    const char *name;
+    uint64_t value;
+  };
+  const Row rows[] = {
+      {"NFA states created", s.nfaStates},
+      {"NFA edges created", s.nfaEdges},
+      {"DFA states (subset construction)", s.dfaStates},
+      {"Epsilon closures", s.closureCalls},
+      {"Epsilon closure states added", s.closureStates},
+      {"Bytes scanned", s.bytesScanned},
+      {"Transitions taken", s.transitions},
+      {"DFA cache hits", s.cacheHits},
+      {"DFA cache misses", s.cacheMisses},
+      {"Matcher DP cells", s.dpCells},
+  };
+  const char *phases[] = {"parse (regex -> NFA)", "determinize (NFA -> DFA)",
+                          "simulate", "approximate match"};
+
+  std::string out;
+  char line[96];
+  for (const Row &row : rows) {
+    std::snprintf(line, sizeof(line), "  %-34s %14llu\n", row.name,
+                  static_cast<unsigned long long>(row.value));
+    out += line;
+  }
+  for (int p = 0; p < EngineStats::PHASES; ++p) {
+    std::snprintf(line, sizeof(line), "  Time in %-26s %11.3f ms\n", phases[p],
+                  s.phaseMillis[p]);
+    out += line;
+  }
+  return out;
+}
+
+} // namespace FormalSystem
@@ -0,0 +1,231 @@
+#include "StreamingValidator.h"
+#include <cctype>
+#include <cstring>
+
+namespace FormalSystem {
+
+StreamingTagValidator::StreamingTagValidator(Mode mode) : mode(mode) {
+  reset();
+}
+
+void StreamingTagValidator::reset() {
+  state = Text;
+  offset = 0;
+  tokenStart = 0;
+  closing = false;
+  lastNonSpace = 0;
+  quote = 0;
+  terminator = nullptr;
+  matched = 0;
+  name.clear();
+  ids.clear();
+  names.clear();
+  stack.clear();
+  maxDepth = 0;
+  status = Ok;
+  errorOffset = 0;
+  message.clear();
+}
+
+bool StreamingTagValidator::feed(const char *data, size_t length) {
+  size_t i = 0;
+  while (i < length && status == Ok) {
+    if (state == Text && mode == XML) {
+      // Text between tags cannot change the state: jump to the next '<'
+      const char *lt =
+          static_cast<const char *>(std::memchr(data + i, '<', length - i));
+      size_t skip = lt ? lt - (data + i) : length - i;
+      i += skip;
+      offset += skip;
+      if (i == length)
+        break;
+    }
+    step(data[i++]);
+    offset++;
+  }
+  return status == Ok;
+}
+
+int32_t StreamingTagValidator::intern(const std::string &symbol) {
+  auto [it, inserted] = ids.emplace(symbol, names.size());
+  if (inserted)
+    names.push_back(symbol);
+  return it->second;
+}
+
+void StreamingTagValidator::fail(Status error, uint64_t at,
+                                 const std::string &text) {
+  status = error;
+  errorOffset = at;
+  message = text;
+}
+
+void StreamingTagValidator::startSkip(const char *end) {
+  state = SkipUntil;
+  terminator = end;
+  matched = 0;
+}
+
+void StreamingTagValidator::openTag() {
+  stack.push_back(intern(name));
+  if (stack.size() > maxDepth)
+    maxDepth = stack.size();
+}
+
+void StreamingTagValidator::closeTag() {
+  std::string shown = mode == XML ? "</" + name + ">" : "'" + name + "'";
+  if (stack.empty()) {
+    fail(UnexpectedClose, tokenStart, "Unexpected " + shown + " (Empty Stack)");
+    return;
+  }
+  // JSON closers are interned under their opening bracket
+  std::string opener = name;
+  if (mode == JSON)
+    opener = name == "}" ? "{" : "[";
+  auto it = ids.find(opener);
+  if (it == ids.end() || it->second != stack.back()) {
+    const std::string &top = names[stack.back()];
+    std::string expected =
+        mode == XML ? "</" + top + ">"
+                    : std::string("'") + (top == "{" ? "}" : "]") + "'";
+    fail(Mismatch, tokenStart, "Expected " + expected + " but found " + shown);
+    return;
+  }
+  stack.pop_back();
+}
+
+void StreamingTagValidator::step(char c) {
+  bool space = std::isspace(static_cast<unsigned char>(c));
+
+  switch (state) {
+  case Text:
+    if (mode == JSON) {
+      if (c == '"') {
+        tokenStart = offset;
+        state = String;
+      } else if (c == '{' || c == '[' || c == '}' || c == ']') {
+        tokenStart = offset;
+        name.assign(1, c);
+        if (c == '{' || c == '[')
+          openTag();
+        else
+          closeTag();
+      }
+    } else if (c == '<') {
+      tokenStart = offset;
+      closing = false;
+      name.clear();
+      state = TagOpen;
+    }
+    break;
+
+  case TagOpen:
+    if (!name.empty()) {
+      // After "<!": comment, CDATA or declaration, decided by the next bytes
+      name += c;
+      if (name == "!--")
+        startSkip("-->");
+      else if (name == "![CDATA[")
+        startSkip("]]>");
+      else if (c == '>')
+        state = Text;
+      else if (std::strncmp(name.c_str(), "!--", name.size()) != 0 &&
+               std::strncmp(name.c_str(), "![CDATA[", name.size()) != 0)
+        startSkip(">");
+    } else if (c == '/' && !closing) {
+      closing = true;
+    } else if (c == '?' && !closing) {
+      startSkip("?>");
+    } else if (c == '!' && !closing) {
+      name.assign(1, '!');
+    } else if (space || c == '>' || c == '/') {
+      state = Text; // '<' not followed by a name is plain text
+    } else {
+      name.assign(1, c);
+      lastNonSpace = c;
+      state = TagName;
+    }
+    break;
+
+  case TagName:
+    if (c == '>' || c == '/' || space) {
+      state = TagRest;
+      step(c);
+    } else if (name.size() == MAX_NAME_LENGTH) {
+      fail(NameTooLong, tokenStart, "Tag name too long");
+    } else {
+      name += c;
+      lastNonSpace = c;
+    }
+    break;
+
+  case TagRest:
+    if (c == '"' || c == '\'') {
+      quote = c;
+      state = TagQuote;
+    } else if (c == '>') {
+      state = Text;
+      if (closing)
+        closeTag();
+      else if (lastNonSpace != '/') // Self-closing tags leave the stack alone
+        openTag();
+    } else if (!space) {
+      lastNonSpace = c;
+    }
+    break;
+
+  case TagQuote:
+    if (c == quote) {
+      lastNonSpace = c;
+      state = TagRest;
+    }
+    break;
+
+  case SkipUntil:
+    if (c == terminator[matched]) {
+      if (terminator[++matched] == '\0')
+        state = Text;
+    } else if (matched >= 2 && c == terminator[0] && c == terminator[1]) {
+      // "--->" or "]]]>": the extra repeated character keeps the prefix
+    } else {
+      matched = c == terminator[0] ? 1 : 0;
+    }
+    break;
+
+  case String:
+    if (c == '\\')
+      state = Escape;
+    else if (c == '"')
+      state = Text;
+    break;
+
+  case Escape:
+    state = String;
+    break;
+  }
+}
+
+StreamingTagValidator::Result StreamingTagValidator::finish() const {
+  Result result{false, status, errorOffset, stack.size(), maxDepth, message};
+  if (status != Ok)
+    return result;
+
+  if (state != Text) {
+    result.status = Unterminated;
+    result.errorOffset = tokenStart;
+    result.message = mode == XML ? "Input ended inside a tag"
+                                 : "Input ended inside a string";
+  } else if (!stack.empty()) {
+    const std::string &top = names[stack.back()];
+    result.status = Unclosed;
+    result.errorOffset = offset;
+    result.message = mode == XML ? "Unclosed <" + top + ">"
+                                 : "Unclosed '" + top + "'";
+  } else {
+    result.valid = true;
+    result.message = "Valid";
+  }
+  return result;
+}
+
+} // namespace FormalSystem
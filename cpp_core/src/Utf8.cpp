@@ -0,0 +1,218 @@
+#include "Utf8.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+
+namespace FormalSystem {
+
+// ====================== Codepoint Sets ======================
+
+void CodepointSet::add(uint32_t lo, uint32_t hi) {
+  if (lo > hi || hi > MAX_CODEPOINT)
+    throw std::runtime_error("Invalid codepoint range");
+  // Merge with every range that overlaps or touches [lo, hi]
+  auto first = std::lower_bound(
+      ranges_.begin(), ranges_.end(), lo,
+      [](const std::pair<uint32_t, uint32_t> &r, uint32_t v) {
+        return r.second + 1 < v;
+      });
+  auto last = first;
+  while (last != ranges_.end() && last->first <= hi + 1) {
+    lo = std::min(lo, last->first);
+    hi = std::max(hi, last->second);
+    ++last;
+  }
+  first = ranges_.erase(first, last);
+  ranges_.insert(first, {lo, hi});
+}
+
+void CodepointSet::negate() {
+  std::vector<std::pair<uint32_t, uint32_t>> gaps;
+  uint32_t next = 0;
+  for (const auto &[lo, hi] : ranges_) {
+    if (lo > next)
+      gaps.push_back({next, lo - 1});
+    next = hi + 1;
+  }
+  if (next <= MAX_CODEPOINT)
+    gaps.push_back({next, MAX_CODEPOINT});
+  ranges_.swap(gaps);
+}
+
+bool CodepointSet::contains(uint32_t codepoint) const {
+  auto it = std::upper_bound(
+      ranges_.begin(), ranges_.end(), codepoint,
+      [](uint32_t v, const std::pair<uint32_t, uint32_t> &r) {
+        return v < r.first;
+      });
+  return it != ranges_.begin() && codepoint <= (it - 1)->second;
+}
+
+// ====================== Encoding ======================
+
+std::string encodeUtf8(uint32_t cp) {
+  std::string out;
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  return out;
+}
+
+uint32_t decodeUtf8(const std::string &text, size_t &i) {
+  auto byte = [&](size_t at) { return static_cast<unsigned char>(text[at]); };
+  unsigned char lead = byte(i);
+  int length = lead < 0x80 ? 1 : lead < 0xC2 ? 0 : lead < 0xE0 ? 2
+               : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+  if (length == 0 || i + length > text.size())
+    throw std::runtime_error("Invalid regex: malformed UTF-8");
+
+  static const uint32_t minimum[] = {0, 0, 0x80, 0x800, 0x10000};
+  uint32_t cp = length == 1 ? lead : lead & (0x7F >> length);
+  for (int k = 1; k < length; ++k) {
+    if ((byte(i + k) & 0xC0) != 0x80)
+      throw std::runtime_error("Invalid regex: malformed UTF-8");
+    cp = (cp << 6) | (byte(i + k) & 0x3F);
+  }
+  if (cp < minimum[length] || cp > CodepointSet::MAX_CODEPOINT ||
+      (cp >= 0xD800 && cp <= 0xDFFF))
+    throw std::runtime_error("Invalid regex: malformed UTF-8");
+  i += length;
+  return cp;
+}
+
+// ====================== Byte Automaton ======================
+
+namespace {
+
+// One byte range per position of the encoding
+using ByteRange = std::pair<unsigned char, unsigned char>;
+using Sequence = std::vector<ByteRange>;
+
+// Splits [lo, hi] until both ends encode to the same length and every
+// continuation position spans either one value or the full 80-BF range, so
+// each piece is exactly the product of its per-byte ranges
+void splitRange(uint32_t lo, uint32_t hi, std::vector<Sequence> &out) {
+  static const uint32_t lengthLimits[] = {0x7F, 0x7FF, 0xFFFF};
+  for (uint32_t limit : lengthLimits) {
+    if (lo <= limit && hi > limit) {
+      splitRange(lo, limit, out);
+      splitRange(limit + 1, hi, out);
+      return;
+    }
+  }
+  for (int k = 1; k < 4; ++k) {
+    uint32_t mask = (1u << (6 * k)) - 1;
+    if ((lo & ~mask) == (hi & ~mask))
+      continue;
+    if ((lo & mask) != 0) {
+      splitRange(lo, lo | mask, out);
+      splitRange((lo | mask) + 1, hi, out);
+      return;
+    }
+    if ((hi & mask) != mask) {
+      splitRange(lo, (hi & ~mask) - 1, out);
+      splitRange(hi & ~mask, hi, out);
+      return;
+    }
+  }
+  std::string a = encodeUtf8(lo), b = encodeUtf8(hi);
+  Sequence sequence;
+  for (size_t k = 0; k < a.size(); ++k)
+    sequence.push_back({static_cast<unsigned char>(a[k]),
+                        static_cast<unsigned char>(b[k])});
+  out.push_back(sequence);
+}
+
+struct TrieNode {
+  std::vector<std::pair<ByteRange, std::unique_ptr<TrieNode>>> children;
+};
+
+using NodeKey = std::vector<std::tuple<int, int, int>>; // lo, hi, target
+
+// Registers the trie below node bottom-up; equal subtrees get one ID
+int intern(const TrieNode &node, Utf8Automaton &out,
+           std::map<NodeKey, int> &registry) {
+  std::vector<Utf8Automaton::Edge> edges;
+  for (const auto &[range, child] : node.children)
+    edges.push_back({range.first, range.second,
+                     intern(*child, out, registry)});
+  std::sort(edges.begin(), edges.end(),
+            [](const Utf8Automaton::Edge &a, const Utf8Automaton::Edge &b) {
+              return a.lo < b.lo;
+            });
+  // Adjacent ranges into the same node become one edge
+  std::vector<Utf8Automaton::Edge> merged;
+  for (const auto &e : edges) {
+    if (!merged.empty() && merged.back().target == e.target &&
+        merged.back().hi + 1 == e.lo)
+      merged.back().hi = e.hi;
+    else
+      merged.push_back(e);
+  }
+
+  NodeKey key;
+  for (const auto &e : merged)
+    key.emplace_back(e.lo, e.hi, e.target);
+  auto it = registry.find(key);
+  if (it != registry.end())
+    return it->second;
+  int id = out.nodes.size();
+  out.nodes.push_back(merged);
+  registry.emplace(std::move(key), id);
+  return id;
+}
+
+} // namespace
+
+Utf8Automaton Utf8Automaton::compile(const CodepointSet &set) {
+  std::vector<Sequence> sequences;
+  for (auto [lo, hi] : set.ranges()) {
+    // Surrogates have no UTF-8 encoding
+    if (lo < 0xD800 && hi >= 0xD800)
+      splitRange(lo, std::min<uint32_t>(hi, 0xD7FF), sequences);
+    if (hi > 0xDFFF)
+      splitRange(std::max<uint32_t>(lo, 0xE000), hi, sequences);
+    if (hi < 0xD800)
+      splitRange(lo, hi, sequences);
+  }
+  if (sequences.empty())
+    throw std::runtime_error("Invalid regex: empty character class");
+
+  // Pieces share a leading range exactly or not at all, so the trie stays
+  // deterministic
+  TrieNode root;
+  for (const auto &sequence : sequences) {
+    TrieNode *node = &root;
+    for (const auto &range : sequence) {
+      auto &children = node->children;
+      auto it = std::find_if(children.begin(), children.end(),
+                             [&](const auto &c) { return c.first == range; });
+      if (it == children.end()) {
+        children.push_back({range, std::make_unique<TrieNode>()});
+        it = children.end() - 1;
+      }
+      node = it->second.get();
+    }
+  }
+
+  Utf8Automaton automaton;
+  std::map<NodeKey, int> registry;
+  intern(root, automaton, registry);
+  return automaton;
+}
+
+} // namespace FormalSystem
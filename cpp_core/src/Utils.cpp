@@ -1,135 +1,61 @@
 #include "Utils.h"
+#include "DotWriter.h"
 #include <fstream>
 #include <iostream>
-#include <sstream>
 
 namespace FormalSystem {
 
-void Utils::exportToDOT(const NFA &nfa, const std::string &filename) {
-  std::ofstream out(filename);
-  if (!out) {
-    std::cerr << "Error opening file: " << filename << "\n";
-    return;
-  }
-
-  out << "digraph NFA {\n";
-  out << "  rankdir=LR;\n";
-  out << "  node [shape=circle];\n";
-
-  // Highlight final states
-  for (const auto &s : nfa.finalStates) {
-    out << "  " << s->id << " [shape=doublecircle];\n";
-  }
-
-  out << "  start [shape=none, label=\"\"];\n";
-  if (nfa.startState) {
-    out << "  start -> " << nfa.startState->id << ";\n";
-  }
-
-  for (const auto &state : nfa.allStates) {
-    for (const auto &[symbol, nextStates] : state->transitions) {
-      for (const auto &next : nextStates) {
-        out << "  " << state->id << " -> " << next->id << " [label=\"" << symbol
-            << "\"];\n";
-      }
-    }
-    for (const auto &next : state->epsilonTransitions) {
-      out << "  " << state->id << " -> " << next->id << " [label=\"ε\"];\n";
-    }
-  }
-
-  out << "}\n";
-  out.close();
-  std::cout << "Exported NFA to " << filename << "\n";
+// Classic format: every symbol gets its own edge, no limits
+static DotOptions classicOptions() {
+  DotOptions options;
+  options.mergeEdges = false;
+  return options;
 }
 
-void Utils::exportToDOT(const DFA &dfa, const std::string &filename) {
-  std::ofstream out(filename);
+template <typename Automaton>
+static void exportAutomaton(const Automaton &automaton,
+                            const std::string &filename, const char *kind) {
+  std::ofstream out(filename, std::ios::binary);
   if (!out) {
     std::cerr << "Error opening file: " << filename << "\n";
     return;
   }
-
-  out << "digraph DFA {\n";
-  out << "  rankdir=LR;\n";
-  out << "  node [shape=circle];\n";
-
-  for (int id : dfa.finalStateIds) {
-    out << "  " << id << " [shape=doublecircle];\n";
+  {
+    DotSink sink([&](const char *data, size_t length) {
+      out.write(data, length);
+    });
+    DotWriter::write(automaton, sink, classicOptions());
   }
-
-  out << "  start [shape=none, label=\"\"];\n";
-  if (dfa.startStateId != -1) {
-    out << "  start -> " << dfa.startStateId << ";\n";
-  }
-
-  for (const auto &[id, state] : dfa.states) {
-    for (const auto &[symbol, nextId] : state.transitions) {
-      out << "  " << id << " -> " << nextId << " [label=\"" << symbol
-          << "\"];\n";
-    }
-  }
-
-  out << "}\n";
   out.close();
-  std::cout << "Exported DFA to " << filename << "\n";
+  std::cout << "Exported " << kind << " to " << filename << "\n";
 }
 
-std::string Utils::generateDOT(const NFA &nfa) {
-  std::stringstream ss;
-  ss << "digraph NFA {\n";
-  ss << "  rankdir=LR;\n";
-  ss << "  node [shape=circle];\n";
-
-  for (const auto &s : nfa.finalStates) {
-    ss << "  " << s->id << " [shape=doublecircle];\n";
+template <typename Automaton>
+static std::string generateAutomaton(const Automaton &automaton) {
+  std::string text;
+  {
+    DotSink sink([&](const char *data, size_t length) {
+      text.append(data, length);
+    });
+    DotWriter::write(automaton, sink, classicOptions());
   }
+  return text;
+}
 
-  ss << "  start [shape=none, label=\"\"];\n";
-  if (nfa.startState) {
-    ss << "  start -> " << nfa.startState->id << ";\n";
-  }
+void Utils::exportToDOT(const NFA &nfa, const std::string &filename) {
+  exportAutomaton(nfa, filename, "NFA");
+}
 
-  for (const auto &state : nfa.allStates) {
-    for (const auto &[symbol, nextStates] : state->transitions) {
-      for (const auto &next : nextStates) {
-        ss << "  " << state->id << " -> " << next->id << " [label=\"" << symbol
-           << "\"];\n";
-      }
-    }
-    for (const auto &next : state->epsilonTransitions) {
-      ss << "  " << state->id << " -> " << next->id << " [label=\"ε\"];\n";
-    }
-  }
+void Utils::exportToDOT(const DFA &dfa, const std::string &filename) {
+  exportAutomaton(dfa, filename, "DFA");
+}
 
-  ss << "}\n";
-  return ss.str();
+std::string Utils::generateDOT(const NFA &nfa) {
+  return generateAutomaton(nfa);
 }
 
 std::string Utils::generateDOT(const DFA &dfa) {
-  std::stringstream ss;
-  ss << "digraph DFA {\n";
-  ss << "  rankdir=LR;\n";
-  ss << "  node [shape=circle];\n";
-
-  for (int id : dfa.finalStateIds) {
-    ss << "  " << id << " [shape=doublecircle];\n";
-  }
-
-  ss << "  start [shape=none, label=\"\"];\n";
-  if (dfa.startStateId != -1) {
-    ss << "  start -> " << dfa.startStateId << ";\n";
-  }
-
-  for (const auto &[id, state] : dfa.states) {
-    for (const auto &[symbol, nextId] : state.transitions) {
-      ss << "  " << id << " -> " << nextId << " [label=\"" << symbol
-         << "\"];\n";
-    }
-  }
-
-  ss << "}\n";
-  return ss.str();
+  return generateAutomaton(dfa);
 }
 
 } // namespace FormalSystem
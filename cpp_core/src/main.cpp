@@ -1,11 +1,24 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "../include/ApproximateRegex.h"
+#include "../include/BatchRunner.h"
+#include "../include/DFAAlgebra.h"
+#include "../include/DotWriter.h"
+#include "../include/Grammar.h"
+#include "../include/LanguageSampler.h"
 #include "../include/Matcher.h"
 #include "../include/PDA.h"
+#include "../include/RNAFolding.h"
 #include "../include/RegexEngine.h"
+#include "../include/Stats.h"
+#include "../include/StreamingValidator.h"
 #include "../include/Utils.h"
 
 using namespace FormalSystem;
@@ -14,21 +27,91 @@ using namespace std;
 void printHelp() {
   cout << "\nCommands:\n";
   cout << "  regex <pattern>       Build NFA and DFA from regex\n";
+  cout << "  counting <pattern>    Build counting automaton (for large {m,n})\n";
   cout << "  match <string>        Test string against current automata\n";
-  cout << "  approx <pat> <txt> <k> Approximate match pattern in text with k "
-          "errors\n";
+  cout << "  count <length>        Count accepted strings of that length\n";
+  cout << "  sample <n> [min [max]] Draw accepted strings uniformly "
+          "('nearmiss' for rejected)\n";
+  cout << "  capture <pat> <txt>   Match and print capture group offsets\n";
+  cout << "  approx <pat> <txt> <k> Approximate match pattern (literal or "
+          "regex) in text with k errors\n";
+  cout << "  equiv <r1> <r2>       Check two regexes for equivalence\n";
+  cout << "  product <and|or|diff|xor> <r1> <r2> Product DFA size and "
+          "shortest word\n";
   cout << "  pda <string>          Run PDA simulation (a^n b^n)\n";
-  cout << "  export                Export current automata to DOT files\n";
+  cout << "  balanced <string>     Check balanced brackets / RNA dot-bracket\n";
+  cout << "  xml <text>            Check XML-like tag nesting\n";
+  cout << "  fold <sequence>       Predict RNA secondary structure (Nussinov)\n";
+  cout << "  grammar <file|rules>  Load CFG (file or ';'-separated rules)\n";
+  cout << "  parse <text>          Test text with CYK and Earley\n";
+  cout << "  validate <xml|json> <file> Stream a file through the nesting "
+          "validator\n";
+  cout << "  export [states [depth]] Export current automata to DOT files "
+          "(bounded: merged edges, SCC clusters)\n";
+  cout << "  stats [reset]         Show (or clear) engine counters and phase "
+          "times\n";
   cout << "  help                  Show this help\n";
   cout << "  exit                  Exit\n";
 }
 
-int main() {
+void printUsage() {
+  cerr << "Usage: formal_sim                      Interactive prompt\n"
+          "       formal_sim --batch <rules> [--threads N] [--filter] "
+          "< input\n"
+          "Batch rules, one per line: 'regex <pattern>' (whole line) or "
+          "'approx <pattern> <k>'.\n"
+          "Prints one line of 0/1 verdicts per input line, or with "
+          "--filter the lines\n"
+          "that match any rule, in input order.\n";
+}
+
+// formal_sim --batch: no prompt, results only (see BatchRunner.h)
+int runBatch(int argc, char **argv) {
+  string rulesPath;
+  BatchRunner::Options options;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "--batch" && i + 1 < argc) {
+      rulesPath = argv[++i];
+    } else if (arg == "--threads" && i + 1 < argc) {
+      options.threads = atoi(argv[++i]);
+    } else if (arg == "--filter") {
+      options.filter = true;
+    } else {
+      printUsage();
+      return 2;
+    }
+  }
+  if (rulesPath.empty()) {
+    printUsage();
+    return 2;
+  }
+  try {
+    BatchRunner runner;
+    runner.loadRules(rulesPath);
+    if (runner.ruleCount() == 0)
+      throw runtime_error("No rules in " + rulesPath);
+    runner.run(stdin, stdout, options);
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1)
+    return runBatch(argc, argv);
+
   cout << "=== Formal Language Simulator CLI ===\n";
 
   NFA currentNFA;
   DFA currentDFA;
+  CountingNFA currentCounting;
   bool hasAutomata = false;
+  bool hasCounting = false;
+  Grammar currentGrammar;
+  bool hasGrammar = false;
   string currentRegex = "";
 
   string line;
@@ -60,23 +143,195 @@ int main() {
         currentNFA = RegexEngine::regexToNFA(pattern);
         currentDFA = RegexEngine::nfaToDFA(currentNFA);
         hasAutomata = true;
+        hasCounting = false; // 'match' reports only this pattern
         cout << "Done. Use 'export' to visualize or 'match' to test.\n";
       } catch (const exception &e) {
         cout << "Error: " << e.what() << "\n";
       }
 
+    } else if (cmd == "counting") {
+      string pattern;
+      ss >> pattern;
+      if (pattern.empty()) {
+        cout << "Usage: counting <pattern>\n";
+        continue;
+      }
+      try {
+        currentCounting = RegexEngine::regexToCountingNFA(pattern);
+        hasCounting = true;
+        // Replace the NFA/DFA of an earlier 'regex' so 'match' and 'export'
+        // describe this pattern too; large bounds cannot be expanded
+        hasAutomata = false;
+        string expandError;
+        try {
+          currentNFA = RegexEngine::regexToNFA(pattern);
+          currentDFA = RegexEngine::nfaToDFA(currentNFA);
+          currentRegex = pattern;
+          hasAutomata = true;
+        } catch (const exception &e) {
+          expandError = e.what();
+        }
+        cout << "Counting automaton: " << currentCounting.nodes.size()
+             << " nodes, " << currentCounting.counters.size()
+             << " counters.\n";
+        if (!hasAutomata)
+          cout << "NFA/DFA not built (" << expandError
+               << "); 'match' uses the counting automaton only.\n";
+      } catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+      }
+
+    } else if (cmd == "fold") {
+      string sequence;
+      ss >> sequence;
+      if (sequence.empty()) {
+        cout << "Usage: fold <sequence>\n";
+        continue;
+      }
+      try {
+        NussinovFolder::Result result = NussinovFolder().fold(sequence);
+        PDA pda;
+        vector<string> log;
+        bool valid = pda.checkBalanced(result.structure, log);
+        cout << sequence << "\n"
+             << result.structure << "\n"
+             << result.pairs << " pairs, PDA check: "
+             << (valid ? "ACCEPT" : "REJECT") << "\n";
+      } catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+      }
+
+    } else if (cmd == "grammar") {
+      string source;
+      getline(ss >> ws, source);
+      if (source.empty()) {
+        cout << "Usage: grammar <file|rules>\n";
+        continue;
+      }
+      string text;
+      if (source.find("->") != string::npos) {
+        for (char c : source)
+          text += c == ';' ? '\n' : c;
+      } else {
+        ifstream file(source);
+        if (!file) {
+          cout << "Cannot open " << source << "\n";
+          continue;
+        }
+        text.assign(istreambuf_iterator<char>(file), {});
+      }
+      try {
+        currentGrammar = Grammar::parse(text);
+        hasGrammar = true;
+        cout << "Grammar (" << currentGrammar.productions.size()
+             << " rules, " << currentGrammar.toCNF().productions.size()
+             << " in CNF):\n"
+             << currentGrammar.toString();
+      } catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+      }
+
+    } else if (cmd == "parse") {
+      if (!hasGrammar) {
+        cout << "No grammar loaded. Use 'grammar' first.\n";
+        continue;
+      }
+      string text;
+      getline(ss >> ws, text);
+      vector<int> tokens = currentGrammar.tokenize(text);
+      cout << "Parsing " << tokens.size() << " tokens:\n";
+      cout << "  CYK: "
+           << (CYKParser(currentGrammar).recognize(tokens) ? "ACCEPT"
+                                                           : "REJECT")
+           << "\n";
+      cout << "  Earley: "
+           << (EarleyParser(currentGrammar).recognize(tokens) ? "ACCEPT"
+                                                              : "REJECT")
+           << "\n";
+
     } else if (cmd == "match") {
-      if (!hasAutomata) {
+      if (!hasAutomata && !hasCounting) {
         cout << "No automata built. Use 'regex' first.\n";
         continue;
       }
       string text;
       ss >> text;
       cout << "Testing '" << text << "':\n";
-      cout << "  NFA: " << (currentNFA.simulate(text) ? "ACCEPT" : "REJECT")
-           << "\n";
-      cout << "  DFA: " << (currentDFA.simulate(text) ? "ACCEPT" : "REJECT")
-           << "\n";
+      if (hasAutomata) {
+        cout << "  NFA: " << (currentNFA.simulate(text) ? "ACCEPT" : "REJECT")
+             << "\n";
+        cout << "  DFA: " << (currentDFA.simulate(text) ? "ACCEPT" : "REJECT")
+             << "\n";
+      }
+      if (hasCounting) {
+        cout << "  Counting: "
+             << (currentCounting.simulate(text) ? "ACCEPT" : "REJECT") << "\n";
+      }
+
+    } else if (cmd == "count" || cmd == "sample" || cmd == "nearmiss") {
+      if (!hasAutomata) {
+        cout << "No automata built. Use 'regex' first.\n";
+        continue;
+      }
+      long long first = -1, minLength = 0, maxLength = -1;
+      ss >> first >> minLength >> maxLength;
+      if (first < 0) {
+        cout << (cmd == "count" ? "Usage: count <length>\n"
+                                : "Usage: " + cmd + " <n> [min [max]]\n");
+        continue;
+      }
+      try {
+        if (cmd == "count") {
+          LanguageSampler sampler(currentDFA, min(first, 4096LL));
+          cout << "log2(count) = " << sampler.log2Count(first) << "\n";
+          if (first <= 4096)
+            cout << "count = " << sampler.countExact(first) << "\n";
+          continue;
+        }
+        if (maxLength < minLength)
+          maxLength = max(minLength, 16LL);
+        LanguageSampler sampler(currentDFA, maxLength);
+        string word;
+        for (long long i = 0; i < first; ++i) {
+          bool ok = cmd == "sample" ? sampler.sample(minLength, maxLength, word)
+                                    : sampler.nearMiss(minLength, maxLength,
+                                                       word);
+          if (!ok) {
+            cout << "No accepted strings with length " << minLength << ".."
+                 << maxLength << "\n";
+            break;
+          }
+          cout << "  '" << word << "'\n";
+        }
+      } catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+      }
+
+    } else if (cmd == "capture") {
+      string pat, txt;
+      ss >> pat >> txt;
+      if (pat.empty()) {
+        cout << "Usage: capture <pattern> <text>\n";
+        continue;
+      }
+      try {
+        CaptureNFA prog = RegexEngine::regexToCaptureNFA(pat);
+        vector<int> caps;
+        bool result = prog.match(txt, caps);
+        cout << "Capture match (" << (prog.isOnePass() ? "one-pass" : "Pike VM")
+             << "): " << (result ? "ACCEPT" : "REJECT") << "\n";
+        for (int g = 0; result && g < prog.groupCount; g++) {
+          cout << "  Group " << g << ": ";
+          if (caps[2 * g] == -1)
+            cout << "(unset)\n";
+          else
+            cout << "[" << caps[2 * g] << ", " << caps[2 * g + 1] << ") \""
+                 << txt.substr(caps[2 * g], caps[2 * g + 1] - caps[2 * g])
+                 << "\"\n";
+        }
+      } catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+      }
 
     } else if (cmd == "approx") {
       string pat, txt;
@@ -86,9 +341,65 @@ int main() {
         cout << "Usage: approx <pattern> <text> <max_errors>\n";
         continue;
       }
-      bool result = Matcher::approximateMatch(txt, pat, k);
-      cout << "Approximate match (" << k
-           << " errors): " << (result ? "FOUND" : "NOT FOUND") << "\n";
+      try {
+        bool result;
+        if (pat.find_first_of("|*(){[\\") == string::npos) {
+          result = Matcher::approximateMatch(txt, pat, k);
+        } else {
+          // Regex patterns: k-error search over the Thompson NFA
+          vector<int32_t> ends;
+          result = ApproximateRegex(pat, k).matchEnds(txt.data(), txt.size(),
+                                                      ends) > 0;
+          cout << ends.size() << " match end(s)";
+          for (size_t i = 0; i < ends.size() && i < 10; ++i)
+            cout << (i ? ", " : ": ") << ends[i];
+          cout << (ends.size() > 10 ? ", ...\n" : "\n");
+        }
+        cout << "Approximate match (" << k
+             << " errors): " << (result ? "FOUND" : "NOT FOUND") << "\n";
+      } catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+      }
+
+    } else if (cmd == "equiv" || cmd == "product") {
+      string op, r1, r2;
+      if (cmd == "product")
+        ss >> op;
+      ss >> r1 >> r2;
+      const vector<string> ops = {"and", "or", "diff", "xor"};
+      auto opIndex = find(ops.begin(), ops.end(), op) - ops.begin();
+      if (r2.empty() || (cmd == "product" && opIndex == 4)) {
+        cout << (cmd == "equiv" ? "Usage: equiv <regex1> <regex2>\n"
+                                : "Usage: product <and|or|diff|xor> <regex1> "
+                                  "<regex2>\n");
+        continue;
+      }
+      try {
+        DenseDFA a(RegexEngine::nfaToDFA(RegexEngine::regexToNFA(r1)));
+        DenseDFA b(RegexEngine::nfaToDFA(RegexEngine::regexToNFA(r2)));
+        if (cmd == "equiv") {
+          string counterexample;
+          if (DFAAlgebra::equivalent(a, b, &counterexample)) {
+            cout << "EQUIVALENT\n";
+          } else {
+            bool inFirst = a.simulate(counterexample);
+            cout << "DIFFERENT: '" << counterexample << "' is accepted only by "
+                 << (inFirst ? r1 : r2) << "\n";
+          }
+          continue;
+        }
+        DenseDFA result = DFAAlgebra::product(
+            a, b, static_cast<DFAAlgebra::Operation>(opIndex));
+        string witness;
+        cout << "Product: " << result.stateCount() << " states, "
+             << result.classCount << " byte classes\n";
+        if (DFAAlgebra::shortestAccepted(result, witness))
+          cout << "Shortest word: '" << witness << "'\n";
+        else
+          cout << "Language is empty\n";
+      } catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+      }
 
     } else if (cmd == "pda") {
       string input;
@@ -102,14 +413,100 @@ int main() {
         cout << "  " << entry << "\n";
       }
 
+    } else if (cmd == "balanced" || cmd == "xml") {
+      string input;
+      if (cmd == "balanced")
+        ss >> input;
+      else
+        getline(ss >> ws, input);
+      PDA pda;
+      vector<string> log;
+      bool result = cmd == "balanced" ? pda.checkBalanced(input, log)
+                                      : pda.checkXML(input, log);
+      cout << "PDA Result: " << (result ? "ACCEPT" : "REJECT") << "\n";
+      cout << "Trace:\n";
+      for (const auto &entry : log) {
+        cout << "  " << entry << "\n";
+      }
+
+    } else if (cmd == "validate") {
+      string kind, path;
+      ss >> kind >> path;
+      if ((kind != "xml" && kind != "json") || path.empty()) {
+        cout << "Usage: validate <xml|json> <file>\n";
+        continue;
+      }
+      ifstream file(path, ios::binary);
+      if (!file) {
+        cout << "Cannot open " << path << "\n";
+        continue;
+      }
+
+      StreamingTagValidator validator(kind == "xml"
+                                          ? StreamingTagValidator::XML
+                                          : StreamingTagValidator::JSON);
+      vector<char> chunk(1 << 16);
+      while (file) {
+        file.read(chunk.data(), chunk.size());
+        if (!validator.feed(chunk.data(), file.gcount()))
+          break;
+      }
+      StreamingTagValidator::Result result = validator.finish();
+      cout << "Result: " << (result.valid ? "VALID" : "INVALID") << " ("
+           << result.message << ")\n";
+      if (!result.valid)
+        cout << "  Error offset: " << result.errorOffset << "\n";
+      cout << "  Max depth: " << result.maxDepth
+           << ", bytes read: " << validator.bytesConsumed() << "\n";
+
+    } else if (cmd == "stats") {
+      string arg;
+      ss >> arg;
+      if (arg == "reset") {
+        Stats::reset();
+        cout << "Statistics reset.\n";
+      } else {
+        cout << "Engine statistics (since start or last reset):\n"
+             << Stats::report();
+      }
+
     } else if (cmd == "export") {
       if (!hasAutomata) {
         cout << "No automata built.\n";
         continue;
       }
-      Utils::exportToDOT(currentNFA, "nfa.dot");
-      Utils::exportToDOT(currentDFA, "dfa.dot");
-      cout << "Exported to nfa.dot and dfa.dot\n";
+      size_t maxStates = 0;
+      int maxDepth = -1;
+      if (!(ss >> maxStates)) {
+        Utils::exportToDOT(currentNFA, "nfa.dot");
+        Utils::exportToDOT(currentDFA, "dfa.dot");
+        cout << "Exported to nfa.dot and dfa.dot\n";
+        continue;
+      }
+      ss >> maxDepth;
+
+      DotOptions options;
+      options.maxStates = maxStates;
+      options.maxDepth = maxDepth;
+      options.clusterSCCs = true;
+      for (const char *name : {"nfa.dot", "dfa.dot"}) {
+        ofstream out(name, ios::binary);
+        if (!out) {
+          cout << "Error opening file: " << name << "\n";
+          continue;
+        }
+        DotSink sink([&](const char *data, size_t length) {
+          out.write(data, length);
+        });
+        DotStats stats = name[0] == 'n'
+                             ? DotWriter::write(currentNFA, sink, options)
+                             : DotWriter::write(currentDFA, sink, options);
+        cout << "Exported " << name << ": " << stats.states << " states, "
+             << stats.edges << " edges, " << stats.clusters << " SCC clusters";
+        if (stats.omittedStates > 0)
+          cout << " (" << stats.omittedStates << " states omitted)";
+        cout << "\n";
+      }
 
     } else {
       cout << "Unknown command. Type 'help'.\n";
@@ -1,6 +1,14 @@
+#include "ApproximateRegex.h"
+#include "DotWriter.h"
+#include "Grammar.h"
+#include "IncrementalCompiler.h"
+#include "LanguageSampler.h"
 #include "Matcher.h"
 #include "PDA.h"
+#include "RNAFolding.h"
 #include "RegexEngine.h"
+#include "Stats.h"
+#include "StreamingValidator.h"
 #include "Utils.h"
 #include <emscripten/bind.h>
 
@@ -20,11 +28,238 @@ PDAResult simulatePDAWrapper(const std::string &input) {
   return {res, log};
 }
 
+PDAResult checkBalancedWrapper(const std::string &input) {
+  PDA pda;
+  std::vector<std::string> log;
+  bool res = pda.checkBalanced(input, log);
+  return {res, log};
+}
+
+PDAResult checkXMLWrapper(const std::string &input) {
+  PDA pda;
+  std::vector<std::string> log;
+  bool res = pda.checkXML(input, log);
+  return {res, log};
+}
+
+// Traced a^n b^n run; the events stay in the caller's PDATrace
+bool simulatePDATracedWrapper(const std::string &input, PDATrace &trace) {
+  PDA pda;
+  trace.clear();
+  return pda.simulate(input, &trace);
+}
+
+// Int32Array over the trace storage (FIELDS values per event, oldest first).
+// No copy: the view is invalidated by the next run or by memory growth.
+val traceEventsView(PDATrace &trace) {
+  const int32_t *data = reinterpret_cast<const int32_t *>(trace.data());
+  return val(typed_memory_view(trace.size() * PDATrace::FIELDS, data));
+}
+
+// Reusable input/output buffer in WASM linear memory. JS writes bytes into
+// input() (e.g. TextEncoder.encodeInto or Uint8Array.set) and the *Buffer
+// entry points read them in place; int results come back through results().
+// Views are invalidated by resize() and by memory growth, so fetch them again
+// after either.
+class ByteBuffer {
+public:
+  explicit ByteBuffer(size_t capacity) { bytes.reserve(capacity); }
+
+  // Sets the input length (grows capacity only when needed); returns input()
+  val resize(size_t length) {
+    bytes.resize(length);
+    return input();
+  }
+  val input() { return val(typed_memory_view(bytes.size(), bytes.data())); }
+  val results() const {
+    return val(typed_memory_view(ints.size(), ints.data()));
+  }
+  size_t length() const { return bytes.size(); }
+  size_t capacity() const { return bytes.capacity(); }
+  void assign(const std::string &data) {
+    bytes.assign(data.begin(), data.end());
+  }
+
+  const char *data() const {
+    return reinterpret_cast<const char *>(bytes.data());
+  }
+  std::vector<int32_t> ints;
+
+private:
+  std::vector<uint8_t> bytes;
+};
+
+bool dfaSimulateBuffer(const DFA &dfa, const ByteBuffer &buffer) {
+  return dfa.simulate(buffer.data(), buffer.length());
+}
+
+// Int32Array of visited state IDs (start state first)
+val dfaTraceBuffer(const DFA &dfa, ByteBuffer &buffer) {
+  std::vector<int> trace;
+  dfa.getTrace(buffer.data(), buffer.length(), trace);
+  buffer.ints.assign(trace.begin(), trace.end());
+  return buffer.results();
+}
+
+bool approximateMatchBuffer(const ByteBuffer &text, const std::string &pattern,
+                            int maxErrors) {
+  return Matcher::approximateMatch(text.data(), text.length(), pattern,
+                                   maxErrors);
+}
+
+// Int32Array of end offsets of approximate occurrences
+val approximateMatchEndsBuffer(ByteBuffer &text, const std::string &pattern,
+                               int maxErrors) {
+  Matcher::approximateMatchEnds(text.data(), text.length(), pattern,
+                                maxErrors, text.ints);
+  return text.results();
+}
+
+bool approximateRegexSearch(const ApproximateRegex &matcher,
+                            const std::string &text) {
+  return matcher.search(text);
+}
+
+bool approximateRegexSearchBuffer(const ApproximateRegex &matcher,
+                                  const ByteBuffer &text) {
+  return matcher.search(text.data(), text.length());
+}
+
+// Int32Array of end offsets of approximate regex occurrences
+val approximateRegexEndsBuffer(const ApproximateRegex &matcher,
+                               ByteBuffer &text) {
+  matcher.matchEnds(text.data(), text.length(), text.ints);
+  return text.results();
+}
+
+bool simulatePDABuffer(const ByteBuffer &input, PDATrace &trace) {
+  PDA pda;
+  trace.clear();
+  return pda.simulate(input.data(), input.length(), &trace);
+}
+
+// Sampled string, or null if no accepted string has a length in range
+val samplerSample(LanguageSampler &sampler, int minLength, int maxLength) {
+  std::string word;
+  if (!sampler.sample(minLength, maxLength, word))
+    return val::null();
+  return val(word);
+}
+
+val samplerNearMiss(LanguageSampler &sampler, int minLength, int maxLength) {
+  std::string word;
+  if (!sampler.nearMiss(minLength, maxLength, word))
+    return val::null();
+  return val(word);
+}
+
+// 64-bit lengths and seeds as JS numbers
+double samplerLog2Count(const LanguageSampler &sampler, double length) {
+  return sampler.log2Count(static_cast<uint64_t>(length));
+}
+
+void samplerSeed(LanguageSampler &sampler, double seed) {
+  sampler.seed(static_cast<uint64_t>(seed));
+}
+
+// Load-test batch: the strings back to back in input(), their end offsets
+// in the returned Int32Array (results())
+val samplerGenerateBuffer(LanguageSampler &sampler, ByteBuffer &buffer,
+                          int count, int minLength, int maxLength,
+                          double nearMissRate) {
+  std::string bytes;
+  buffer.ints.clear();
+  sampler.generate(count, minLength, maxLength, nearMissRate, bytes,
+                   buffer.ints);
+  buffer.assign(bytes);
+  return buffer.results();
+}
+
+bool dfaSimulate(DFA &dfa, const std::string &input) {
+  return dfa.simulate(input);
+}
+
+std::vector<int> dfaGetTrace(DFA &dfa, const std::string &input) {
+  return dfa.getTrace(input);
+}
+
+bool approximateMatchWrapper(const std::string &text,
+                             const std::string &pattern, int maxErrors) {
+  return Matcher::approximateMatch(text, pattern, maxErrors);
+}
+
+// StreamingTagValidator::Result with the 64-bit offset as a JS number
+struct ValidationResult {
+  bool valid;
+  int status;
+  double errorOffset;
+  size_t depth;
+  size_t maxDepth;
+  std::string message;
+};
+
+// Chunks may be JS strings (UTF-8 encoded) or Uint8Arrays of raw bytes
+bool feedChunk(StreamingTagValidator &validator, const std::string &chunk) {
+  return validator.feed(chunk);
+}
+
+ValidationResult finishValidation(const StreamingTagValidator &validator) {
+  StreamingTagValidator::Result r = validator.finish();
+  return {r.valid, r.status, static_cast<double>(r.errorOffset),
+          r.depth, r.maxDepth, r.message};
+}
+
+// Parser front ends taking raw text, tokenized by the grammar
+bool cykRecognize(const CYKParser &parser, const std::string &text) {
+  return parser.recognize(text);
+}
+
+bool earleyRecognize(const EarleyParser &parser, const std::string &text) {
+  return parser.recognize(text);
+}
+
+NussinovFolder::Result foldRNAWrapper(const std::string &sequence) {
+  return NussinovFolder().fold(sequence);
+}
+
+// Capture offsets (start, end per group), empty if the input is rejected
+std::vector<int> matchCapturesWrapper(const CaptureNFA &nfa,
+                                      const std::string &input) {
+  std::vector<int> captures;
+  if (!nfa.match(input, captures))
+    captures.clear();
+  return captures;
+}
+
+int dfaStateCount(const DFA &dfa) { return dfa.states.size(); }
+
 // Helper to disambiguate overloaded functions
 std::string generateDOT_NFA(const NFA &nfa) { return Utils::generateDOT(nfa); }
 
 std::string generateDOT_DFA(const DFA &dfa) { return Utils::generateDOT(dfa); }
 
+// Bounded, edge-merged DOT for the diagram view (large automata)
+template <typename Automaton>
+std::string generateDOTBounded(const Automaton &automaton,
+                               const DotOptions &options) {
+  std::string dot;
+  {
+    DotSink sink([&](const char *data, size_t length) {
+      dot.append(data, length);
+    });
+    DotWriter::write(automaton, sink, options);
+  }
+  return dot;
+}
+
+std::string generateDOTBounded_NFA(const NFA &nfa, const DotOptions &options) {
+  return generateDOTBounded(nfa, options);
+}
+
+std::string generateDOTBounded_DFA(const DFA &dfa, const DotOptions &options) {
+  return generateDOTBounded(dfa, options);
+}
+
 EMSCRIPTEN_BINDINGS(formal_system) {
   register_vector<std::string>("StringList");
   register_vector<int>("IntList");
@@ -39,15 +274,129 @@ EMSCRIPTEN_BINDINGS(formal_system) {
   // as value types or classes. Since they are copyable, class_ is fine.
   class_<NFA>("NFA").function("simulate", &NFA::simulate);
   class_<DFA>("DFA")
-      .function("simulate", &DFA::simulate)
-      .function("getTrace", &DFA::getTrace);
+      .function("simulate", &dfaSimulate)
+      .function("getTrace", &dfaGetTrace)
+      .function("simulateBuffer", &dfaSimulateBuffer)
+      .function("traceBuffer", &dfaTraceBuffer)
+      .function("stateCount", &dfaStateCount);
+
+  class_<ByteBuffer>("ByteBuffer")
+      .constructor<size_t>()
+      .function("resize", &ByteBuffer::resize)
+      .function("input", &ByteBuffer::input)
+      .function("results", &ByteBuffer::results)
+      .function("length", &ByteBuffer::length)
+      .function("capacity", &ByteBuffer::capacity);
+
+  class_<ApproximateRegex>("ApproximateRegex")
+      .constructor<const std::string &, int>()
+      .function("maxErrors", &ApproximateRegex::maxErrors)
+      .function("stateCount", &ApproximateRegex::stateCount)
+      .function("search", &approximateRegexSearch)
+      .function("searchBuffer", &approximateRegexSearchBuffer)
+      .function("matchEndsBuffer", &approximateRegexEndsBuffer);
+
+  class_<LanguageSampler>("LanguageSampler")
+      .constructor<const DFA &, int>()
+      .function("maxLength", &LanguageSampler::maxLength)
+      .function("stateCount", &LanguageSampler::stateCount)
+      .function("log2Count", &samplerLog2Count)
+      .function("countExact", &LanguageSampler::countExact)
+      .function("seed", &samplerSeed)
+      .function("sample", &samplerSample)
+      .function("nearMiss", &samplerNearMiss)
+      .function("generateBuffer", &samplerGenerateBuffer);
+
+  class_<CountingNFA>("CountingNFA")
+      .function("simulate", &CountingNFA::simulate);
+
+  class_<CaptureNFA>("CaptureNFA")
+      .function("simulate", &CaptureNFA::simulate)
+      .function("isOnePass", &CaptureNFA::isOnePass)
+      .property("groupCount", &CaptureNFA::groupCount);
+
+  value_object<IncrementalCompiler::Stats>("IncrementalStats")
+      .field("expressions", &IncrementalCompiler::Stats::expressions)
+      .field("stateSets", &IncrementalCompiler::Stats::stateSets)
+      .field("computedTransitions",
+             &IncrementalCompiler::Stats::computedTransitions)
+      .field("reusedTransitions",
+             &IncrementalCompiler::Stats::reusedTransitions)
+      .field("tooLarge", &IncrementalCompiler::Stats::tooLarge);
+
+  class_<IncrementalCompiler>("IncrementalCompiler")
+      .constructor<>()
+      .function("compile", &IncrementalCompiler::compile)
+      .function("clear", &IncrementalCompiler::clear)
+      .function("lastStats", &IncrementalCompiler::lastStats);
+
+  class_<PDATrace>("PDATrace")
+      .constructor<size_t>()
+      .property("enabled", &PDATrace::enabled)
+      .function("clear", &PDATrace::clear)
+      .function("size", &PDATrace::size)
+      .function("capacity", &PDATrace::capacity)
+      .function("dropped", &PDATrace::dropped)
+      .function("events", &traceEventsView);
+
+  value_object<NussinovFolder::Result>("FoldResult")
+      .field("structure", &NussinovFolder::Result::structure)
+      .field("score", &NussinovFolder::Result::score)
+      .field("pairs", &NussinovFolder::Result::pairs);
+
+  value_object<DotOptions>("DotOptions")
+      .field("maxStates", &DotOptions::maxStates)
+      .field("maxDepth", &DotOptions::maxDepth)
+      .field("mergeEdges", &DotOptions::mergeEdges)
+      .field("clusterSCCs", &DotOptions::clusterSCCs)
+      .field("nodePrefix", &DotOptions::nodePrefix);
+
+  enum_<StreamingTagValidator::Mode>("ValidatorMode")
+      .value("XML", StreamingTagValidator::XML)
+      .value("JSON", StreamingTagValidator::JSON);
+
+  value_object<ValidationResult>("ValidationResult")
+      .field("valid", &ValidationResult::valid)
+      .field("status", &ValidationResult::status)
+      .field("errorOffset", &ValidationResult::errorOffset)
+      .field("depth", &ValidationResult::depth)
+      .field("maxDepth", &ValidationResult::maxDepth)
+      .field("message", &ValidationResult::message);
+
+  class_<StreamingTagValidator>("StreamingTagValidator")
+      .constructor<StreamingTagValidator::Mode>()
+      .function("feed", &feedChunk)
+      .function("finish", &finishValidation)
+      .function("reset", &StreamingTagValidator::reset)
+      .function("depth", &StreamingTagValidator::depth);
+
+  class_<Grammar>("Grammar")
+      .class_function("parse", &Grammar::parse)
+      .function("toString", &Grammar::toString)
+      .function("toCNF", &Grammar::toCNF)
+      .function("isCNF", &Grammar::isCNF);
+
+  class_<CYKParser>("CYKParser")
+      .constructor<const Grammar &>()
+      .function("recognize", &cykRecognize);
+
+  class_<EarleyParser>("EarleyParser")
+      .constructor<const Grammar &>()
+      .function("recognize", &earleyRecognize)
+      .function("lastItemCount", &EarleyParser::lastItemCount);
 
   class_<RegexEngine>("RegexEngine")
       .class_function("regexToNFA", &RegexEngine::regexToNFA)
-      .class_function("nfaToDFA", &RegexEngine::nfaToDFA);
+      .class_function("nfaToDFA", &RegexEngine::nfaToDFA)
+      .class_function("regexToCountingNFA",
+                      &RegexEngine::regexToCountingNFA)
+      .class_function("regexToCaptureNFA", &RegexEngine::regexToCaptureNFA);
 
-  class_<Matcher>("Matcher").class_function("approximateMatch",
-                                            &Matcher::approximateMatch);
+  class_<Matcher>("Matcher")
+      .class_function("approximateMatch", &approximateMatchWrapper)
+      .class_function("approximateMatchBuffer", &approximateMatchBuffer)
+      .class_function("approximateMatchEndsBuffer",
+                      &approximateMatchEndsBuffer);
 
   // Utils is a static class, but we can expose functions directly or as class
   // functions Exposing as free functions for simplicity in JS, or attached to a
@@ -56,5 +405,15 @@ EMSCRIPTEN_BINDINGS(formal_system) {
 
   function("generateDOT_NFA", &generateDOT_NFA);
   function("generateDOT_DFA", &generateDOT_DFA);
+  function("generateDOTBounded_NFA", &generateDOTBounded_NFA);
+  function("generateDOTBounded_DFA", &generateDOTBounded_DFA);
   function("simulatePDA", &simulatePDAWrapper);
+  function("simulatePDATraced", &simulatePDATracedWrapper);
+  function("simulatePDABuffer", &simulatePDABuffer);
+  function("checkBalancedPDA", &checkBalancedWrapper);
+  function("checkXMLPDA", &checkXMLWrapper);
+  function("foldRNA", &foldRNAWrapper);
+  function("matchCaptures", &matchCapturesWrapper);
+  function("statsReport", &Stats::report);
+  function("resetStats", &Stats::reset);
 }
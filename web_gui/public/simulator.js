@@ -2,6 +2,7 @@
 // Main Application Logic
 const AppState = {
     wasmModule: null,
+    incrementalCompiler: null, // Keeps memoized DFA work between keystrokes
     currentNFA: null,
     currentDFA: null,
     activeDiagram: 'nfa', // 'nfa' or 'dfa'
@@ -11,6 +12,11 @@ const AppState = {
     testString: 'abb',
     dnaSequence: 'ball',
     maxErrors: 1,
+    maxDiagramStates: 300, // Larger automata collapse into a "more" node
+    inputBuffer: null,     // Reused WASM ByteBuffer for long inputs
+    workerPool: null,      // WasmWorkerPool, created on first long job
+    approxJob: null,       // Running pooled approximate match
+    poolThreshold: 1 << 16, // Texts this long are matched off the main thread
 
     init: async function () {
         console.log("Initializing App... Version: UI_UPDATE_2");
@@ -20,6 +26,9 @@ const AppState = {
                 return;
             }
             this.wasmModule = await createFormalSimModule();
+            if (this.wasmModule.IncrementalCompiler) {
+                this.incrementalCompiler = new this.wasmModule.IncrementalCompiler();
+            }
             console.log("WASM Core Ready");
 
             // Enable buttons
@@ -134,17 +143,31 @@ const AppState = {
         this.regex = val;
         this.saveState();
 
-        // 3. Highlight Invalid Regex
+        // 3. Highlight Invalid Regex (incremental C++ compile, cheap per keystroke)
         const field = document.getElementById("regex-input-field");
+        let explanation = this.explainRegex(val);
         try {
-            new RegExp(val); // basic JS check
+            if (this.incrementalCompiler && val) {
+                const dfa = this.incrementalCompiler.compile(val);
+                const stats = this.incrementalCompiler.lastStats();
+                explanation += ` (${dfa.stateCount()} DFA states, ${stats.reusedTransitions} transitions reused)`;
+                dfa.delete();
+            } else {
+                new RegExp(val); // basic JS check until WASM is ready
+            }
             field.style.border = "2px solid #4CAF50"; // green
         } catch (e) {
-            field.style.border = "2px solid #FF5252"; // red
+            // A valid pattern past the compiler's DFA size limit is not an error
+            if (this.incrementalCompiler && val && this.incrementalCompiler.lastStats().tooLarge) {
+                explanation += ' (DFA too large to preview)';
+                field.style.border = "2px solid #FFC107"; // amber
+            } else {
+                field.style.border = "2px solid #FF5252"; // red
+            }
         }
 
         // 4. Real-Time Explanation
-        document.getElementById("regex-explanation").textContent = this.explainRegex(val);
+        document.getElementById("regex-explanation").textContent = explanation;
     },
 
     handleTestStringChange: function (val) {
@@ -268,7 +291,9 @@ const AppState = {
 
         try {
             // Run simulation for Result
-            let isMatch = this.currentDFA.simulate(this.testString);
+            let isMatch = this.wasmModule.ByteBuffer
+                ? this.currentDFA.simulateBuffer(this.writeInputBuffer(this.testString))
+                : this.currentDFA.simulate(this.testString);
 
             const resultBadge = isMatch
                 ? '<span class="px-2 py-0.5 rounded bg-green-500/20 text-green-400 text-[10px] font-bold border border-green-500/30 tracking-wide">MATCH</span>'
@@ -298,6 +323,84 @@ const AppState = {
         }
     },
 
+    formatMatchEnds: function (ends) {
+        if (!ends || ends.length === 0) return '';
+        const shown = Array.from(ends.subarray(0, 10)).join(', ');
+        return `\nEnds at: ${shown}${ends.length > 10 ? ` ... (${ends.length} total)` : ''}`;
+    },
+
+    // Worker pool for long jobs; null where workers are unavailable (file://)
+    getWorkerPool: function () {
+        if (this.workerPool) return this.workerPool;
+        if (typeof WasmWorkerPool === 'undefined' || typeof Worker === 'undefined') return null;
+        if (location.protocol === 'file:') return null;
+        try {
+            this.workerPool = new WasmWorkerPool();
+        } catch (e) {
+            console.error("Worker pool unavailable", e);
+            return null;
+        }
+        return this.workerPool;
+    },
+
+    // Long texts: split across workers, with progress and a cancel button
+    runApproximateMatchPooled: function (pattern, text, k, resultDiv) {
+        if (this.approxJob) this.approxJob.cancel();
+
+        const badge = (cls, label) =>
+            `<span class="px-2 py-0.5 rounded bg-${cls}-500/20 text-${cls}-400 text-[10px] font-bold border border-${cls}-500/30 tracking-wide">${label}</span>`;
+        resultDiv.innerHTML = `
+            <div class="px-3 py-2 bg-gray-900 border-b border-gray-800 flex justify-between items-center">
+                <div class="flex items-center">
+                    <span class="text-xs bg-gray-700 text-gray-300 px-2 py-0.5 rounded font-mono border border-gray-600 flex items-center">
+                        <span class="text-blue-400 font-bold mr-2">APPROX (k=${k})</span> ${text.length.toLocaleString()} chars
+                    </span>
+                </div>
+                <span class="approx-status">${badge('yellow', 'RUNNING 0%')}</span>
+            </div>
+            <div class="p-2 text-[10px] font-mono text-gray-400 whitespace-pre-wrap max-h-32 overflow-y-auto custom-scrollbar"><span class="approx-detail">Pattern: "${this.escapeHtml(pattern)}"</span>
+<button class="approx-cancel text-red-400 hover:text-red-300 underline">Cancel</button></div>
+        `;
+        const status = resultDiv.querySelector('.approx-status');
+        const detail = resultDiv.querySelector('.approx-detail');
+        const cancelButton = resultDiv.querySelector('.approx-cancel');
+
+        const onProgress = (done, total) => {
+            status.innerHTML = badge('yellow', `RUNNING ${Math.floor(100 * done / total)}%`);
+        };
+        const job = this.isRegexPattern(pattern)
+            ? this.workerPool.approximateRegexMatch(text, pattern, k, { onProgress })
+            : this.workerPool.approximateMatch(text, pattern, k, { onProgress });
+        this.approxJob = job;
+        cancelButton.onclick = () => job.cancel();
+
+        job.promise.then(({ matched, ends }) => {
+            status.innerHTML = matched ? badge('green', 'MATCH') : badge('red', 'NO MATCH');
+            detail.textContent += this.formatMatchEnds(ends);
+        }).catch(e => {
+            status.innerHTML = e.cancelled ? badge('gray', 'CANCELLED') : badge('red', 'ERROR');
+            if (!e.cancelled) detail.textContent += `\nError: ${e.message}`;
+        }).finally(() => {
+            cancelButton.remove();
+            if (this.approxJob === job) this.approxJob = null;
+        });
+    },
+
+    // Operators switch approximate matching from Levenshtein on a literal to
+    // the k-error regex search
+    isRegexPattern: function (pattern) {
+        return /[|*(){}[\\]/.test(pattern);
+    },
+
+    // Encodes text as UTF-8 straight into the shared WASM input buffer
+    writeInputBuffer: function (text) {
+        if (!this.inputBuffer) this.inputBuffer = new this.wasmModule.ByteBuffer(1 << 16);
+        const view = this.inputBuffer.resize(text.length * 3); // UTF-8 worst case
+        const { written } = new TextEncoder().encodeInto(text, view);
+        this.inputBuffer.resize(written);
+        return this.inputBuffer;
+    },
+
     runApproximateMatch: function () {
         this.clearError();
         if (!this.wasmModule) return;
@@ -313,8 +416,36 @@ const AppState = {
         const resultDiv = document.createElement('div');
         resultDiv.className = 'bg-gray-800 rounded-lg border border-gray-700 mb-3 overflow-hidden shadow-sm';
 
+        if (text.length >= this.poolThreshold && this.getWorkerPool()) {
+            this.runApproximateMatchPooled(pattern, text, k, resultDiv);
+            resultsContainer.insertBefore(resultDiv, resultsContainer.firstChild);
+            return;
+        }
+
         try {
-            const isMatch = this.wasmModule.Matcher.approximateMatch(text, pattern, k);
+            let isMatch;
+            let endsNote = '';
+            if (this.isRegexPattern(pattern)) {
+                if (!this.wasmModule.ApproximateRegex) {
+                    throw new Error('Regex patterns need a newer WASM build (ApproximateRegex)');
+                }
+                const matcher = new this.wasmModule.ApproximateRegex(pattern, k);
+                try {
+                    const ends = matcher.matchEndsBuffer(this.writeInputBuffer(text));
+                    isMatch = ends.length > 0;
+                    endsNote = this.formatMatchEnds(ends);
+                } finally {
+                    matcher.delete();
+                }
+            } else if (this.wasmModule.ByteBuffer) {
+                // Int32Array view into WASM memory; read it before the next call
+                const ends = this.wasmModule.Matcher.approximateMatchEndsBuffer(
+                    this.writeInputBuffer(text), pattern, k);
+                isMatch = ends.length > 0;
+                endsNote = this.formatMatchEnds(ends);
+            } else {
+                isMatch = this.wasmModule.Matcher.approximateMatch(text, pattern, k);
+            }
 
             const resultBadge = isMatch
                 ? '<span class="px-2 py-0.5 rounded bg-green-500/20 text-green-400 text-[10px] font-bold border border-green-500/30 tracking-wide">MATCH</span>'
@@ -329,7 +460,7 @@ const AppState = {
                     </div>
                     ${resultBadge}
                 </div>
-                <div class="p-2 text-[10px] font-mono text-gray-400 whitespace-pre-wrap max-h-32 overflow-y-auto custom-scrollbar">Pattern: "${pattern}"</div>
+                <div class="p-2 text-[10px] font-mono text-gray-400 whitespace-pre-wrap max-h-32 overflow-y-auto custom-scrollbar">Pattern: "${pattern}"${endsNote}</div>
             `;
             resultsContainer.insertBefore(resultDiv, resultsContainer.firstChild);
 
@@ -360,7 +491,7 @@ const AppState = {
             desc.innerHTML = `Simulates <b>a<sup>n</sup>b<sup>n</sup></b> context-free language.`;
             document.getElementById('pda-input-field').placeholder = "e.g. aaabbb";
         } else {
-            desc.innerHTML = `Checks for <b>XML Tags / RNA Loops</b> (Balanced Parentheses).`;
+            desc.innerHTML = `Checks for <b>XML Tags / RNA Loops</b> (Balanced Parentheses). An RNA sequence is folded first.`;
             document.getElementById('pda-input-field').placeholder = "e.g. ((...))";
         }
     },
@@ -416,9 +547,9 @@ const AppState = {
             text = this.injectPattern(bg, 'ATG', 0.1);
         }
         if (type === 'TATA') {
-            // Use a canonical consensus sequence for the pattern since Matcher uses Levenshtein on literals
-            pattern = 'TATAAAA';
-            const sample = 'TATAAAA';
+            // Consensus TATAWAW (W = A or T), searched as a regex with k errors
+            pattern = 'TATA(A|T)A(A|T)';
+            const sample = 'TATAAAT';
             text = this.injectPattern(bg, sample, 0.2);
         }
         if (type === 'POLYA') {
@@ -439,6 +570,22 @@ const AppState = {
     },
 
     setRandomTestString: function () {
+        // Draw uniformly from the strings the DFA accepts (length 5 to 10,
+        // else any length up to 32); newer WASM builds only
+        if (this.wasmModule && this.wasmModule.LanguageSampler && this.currentDFA) {
+            const sampler = new this.wasmModule.LanguageSampler(this.currentDFA, 32);
+            try {
+                let word = sampler.sample(5, 10);
+                if (word === null) word = sampler.sample(0, 32);
+                if (word !== null) {
+                    this.setTestString(word);
+                    return;
+                }
+            } finally {
+                sampler.delete();
+            }
+        }
+
         // Extract potential literals from regex
         // Simple heuristic: remove special chars
         const literals = this.regex.replace(/[^a-zA-Z0-9]/g, '');
@@ -469,153 +616,48 @@ const AppState = {
             let isAccepted = false;
             let stackTrace = "";
 
-            if (this.pdaMode === 'balanced') {
-                // simple JS simulation for Balanced Parentheses
-                let stack = [];
-                let trace = [];
-                let failed = false;
-
-                trace.push(`Start: Stack []`);
-
-                // --- LEXER & SIMULATION LOGIC ---
-                let isXML = false;
-
-                // Detect XML-like input (must have tags)
-                if (input.includes('<') && input.includes('>')) {
-                    isXML = true;
-                }
-
-                if (isXML) {
-                    // --- XML STRICT MODE ---
-                    trace.push(`Lexer: XML detected. Running strict tag validation...`);
-
-                    // Regex to find tags: Capture group 1 is '/' (if closing), group 2 is 'tagName'
-                    // We ignore attributes for validation: <div class="x"> -> div
-                    const tagRegex = /<(\/?)([^>\s\/]+)[^>]*>/g;
-                    let match;
-                    let foundTags = false;
-
-                    // We will iterate purely over the tags found. Text content is ignored for structure.
-                    while ((match = tagRegex.exec(input)) !== null) {
-                        foundTags = true;
-                        const fullTag = match[0]; // e.g. <title>
-                        const isClose = match[1] === '/';
-                        const tagName = match[2];
-
-                        // Skip self-closing tags? Usually XML parsers handle <br/>.
-                        // Our regex might match <br/> as tagName="br". 
-                        // If the tag ends with /> it's self closing. match[0] ends with />?
-                        if (fullTag.trim().endsWith('/>')) {
-                            trace.push(`Read '${fullTag}': Self-closing. Ignore.`);
-                            continue;
-                        }
-
-                        if (!isClose) {
-                            // OPEN TAG
-                            stack.push({ name: tagName, raw: fullTag });
-                            trace.push(
-                                `<span class="text-gray-500">Read</span> <span class="text-blue-400 font-bold">&lt;${tagName}&gt;</span>: ` +
-                                `<span class="px-1.5 py-0.5 bg-green-900/40 text-green-400 rounded text-[9px] uppercase font-bold tracking-wider border border-green-700/50">PUSH</span> ` +
-                                `<span class="text-gray-400">Stack size: ${stack.length}</span>`
-                            );
-                        } else {
-                            // CLOSE TAG
-                            if (stack.length === 0) {
-                                trace.push(
-                                    `<span class="text-gray-500">Read</span> <span class="text-blue-400 font-bold">&lt;/${tagName}&gt;</span>: ` +
-                                    `<span class="px-1.5 py-0.5 bg-red-900/40 text-red-400 rounded text-[9px] uppercase font-bold tracking-wider border border-red-700/50">ERROR</span> ` +
-                                    `<span class="text-red-300">Empty Stack</span>`
-                                );
-                                failed = true;
-                                break;
-                            }
-
-                            const top = stack.pop();
-
-                            // STRICT NAME CHECK
-                            if (top.name !== tagName) {
-                                trace.push(
-                                    `<span class="text-gray-500">Read</span> <span class="text-blue-400 font-bold">&lt;/${tagName}&gt;</span>: ` +
-                                    `<span class="px-1.5 py-0.5 bg-red-900/40 text-red-400 rounded text-[9px] uppercase font-bold tracking-wider border border-red-700/50">MISMATCH</span> ` +
-                                    `<span class="text-red-300">Expected &lt;/${top.name}&gt;</span>`
-                                );
-                                failed = true;
-                                break;
-                            }
-
-                            trace.push(
-                                `<span class="text-gray-500">Read</span> <span class="text-blue-400 font-bold">&lt;/${tagName}&gt;</span>: ` +
-                                `<span class="px-1.5 py-0.5 bg-yellow-900/40 text-yellow-400 rounded text-[9px] uppercase font-bold tracking-wider border border-yellow-700/50">POP</span> ` +
-                                `<span class="text-gray-400">Matches &lt;${top.name}&gt;</span>`
-                            );
-                        }
-                    }
-
-                    if (!foundTags) {
-                        trace.push(`<span class="text-yellow-500 italic">Warning: No valid tags found in XML mode.</span>`);
-                    }
-
-                } else {
-                    // --- STANDARD / RNA MODE (Char-by-Char) ---
-                    for (let i = 0; i < input.length; i++) {
-                        const char = input[i];
-                        if (char === '(') {
-                            // Push index to check loop size later
-                            stack.push(i);
-                            trace.push(`Read '(': Push (Index ${i}). Stack size: ${stack.length}`);
-                        } else if (char === ')') {
-                            if (stack.length === 0) {
-                                trace.push(`Read ')': Error (Empty Stack). REJECT.`);
-                                failed = true;
-                                break;
-                            }
-                            const openIndex = stack.pop();
-                            const loopSize = i - openIndex - 1;
-
-                            // BIO-CONSTRAINT: Hairpin loops must be at least 3 bases long.
-                            if (loopSize < 3) {
-                                trace.push(`Read ')': Error (Steric Hindrance). Loop size ${loopSize} < 3. REJECT.`);
-                                failed = true;
-                                break;
-                            }
-
-                            trace.push(`Read ')': Pop (matches index ${openIndex}). Loop size: ${loopSize}. OK.`);
-                        } else {
-                            trace.push(`Read '${char}': Unpaired base.`);
-                        }
-                    }
-                }
+            if (!this.wasmModule) return;
 
-                if (!failed && stack.length === 0) {
-                    isAccepted = true;
-                    trace.push(`<span class="text-green-400 font-bold">End: Stack Empty. Structure Valid. ACCEPT.</span>`);
-                } else if (!failed) {
-                    trace.push(`<span class="text-red-400 font-bold">End: Stack [${stack.length} items] (Not Empty). REJECT.</span>`);
+            let result;
+            let foldLines = [];
+            if (this.pdaMode === 'balanced') {
+                // Input with tags goes to the XML tag checker, anything else
+                // to the RNA dot-bracket checker (both run in the C++ PDA;
+                // a module built without them falls back to the JS checker)
+                const isXML = input.includes('<') && input.includes('>');
+                const check = (isXML ? this.wasmModule.checkXMLPDA : this.wasmModule.checkBalancedPDA)
+                    || (text => this.checkBalancedJS(text, isXML));
+                let structure = input;
+                if (/^[ACGUTacgut]+$/.test(input) && this.wasmModule.foldRNA) {
+                    // A raw sequence is folded first, then its structure is checked
+                    const folded = this.wasmModule.foldRNA(input);
+                    structure = folded.structure;
+                    foldLines = [
+                        `Sequence:  ${input}`,
+                        `Predicted: ${structure} (${folded.pairs} pairs, Nussinov)`
+                    ];
                 }
+                result = check(structure);
+            } else if (this.wasmModule.PDATrace) {
+                // Default: a^n b^n (WASM), traced into a reusable binary buffer
+                result = this.runTracedPda(input);
+            } else {
+                result = this.wasmModule.simulatePDA(input);
+            }
 
-                // If trace contains HTML, we shouldn't join with \n but use <br> or just let innerHTML handle divs? 
-                // The container handles whitespace-pre-wrap, so \n is fine, but we are injecting HTML spans now.
-                // We must ensure the DISPLAY uses innerHTML.
-                // Looking at line 558: resultDiv.innerHTML = ... ${stackTrace} ...
-                // So yes, we can inject HTML spans. Join with \n is OK for pre-wrap.
-                stackTrace = trace.join('\n');
-
+            // result is { accepted: bool, log: vector<string> }
+            isAccepted = result.accepted;
+            let traceLines = foldLines.map(line => this.escapeHtml(line));
+            if (Array.isArray(result.log)) {
+                traceLines = traceLines.concat(result.log.map(line => this.formatPdaLogLine(line)));
             } else {
-                // Default: a^n b^n (WASM)
-                if (this.wasmModule) {
-                    const result = this.wasmModule.simulatePDA(input);
-                    // result is { accepted: bool, log: vector<string> }
-                    isAccepted = result.accepted;
-
-                    // Convert vector to string
-                    const logVec = result.log;
-                    let traceLines = [];
-                    for (let i = 0; i < logVec.size(); i++) {
-                        traceLines.push(logVec.get(i));
-                    }
-                    stackTrace = traceLines.join('\n');
+                const logVec = result.log;
+                for (let i = 0; i < logVec.size(); i++) {
+                    traceLines.push(this.formatPdaLogLine(logVec.get(i)));
                 }
+                logVec.delete();
             }
+            stackTrace = traceLines.join('\n');
 
             const resultBadge = isAccepted
                 ? '<span class="px-2 py-0.5 rounded bg-green-500/20 text-green-400 text-[10px] font-bold border border-green-500/30 tracking-wide">ACCEPTED</span>'
@@ -627,7 +669,7 @@ const AppState = {
                 <div class="px-3 py-2 bg-gray-900 border-b border-gray-800 flex justify-between items-center">
                     <div class="flex items-center">
                         <span class="text-xs bg-gray-700 text-gray-300 px-2 py-0.5 rounded font-mono border border-gray-600 flex items-center">
-                            <span class="text-orange-400 font-bold mr-2">PDA (${this.pdaMode})</span> "${input}"
+                            <span class="text-orange-400 font-bold mr-2">PDA (${this.pdaMode})</span> "${this.escapeHtml(input)}"
                         </span>
                     </div>
                     ${resultBadge}
@@ -643,6 +685,130 @@ const AppState = {
         }
     },
 
+    // Runs the a^n b^n PDA with a binary trace and formats only the events
+    // that are kept (the buffer holds the most recent PDA_TRACE_CAPACITY).
+    runTracedPda: function (input) {
+        const PDA_TRACE_CAPACITY = 4096;
+        if (!this.pdaTrace) {
+            this.pdaTrace = new this.wasmModule.PDATrace(PDA_TRACE_CAPACITY);
+        }
+        const accepted = this.wasmModule.simulatePDATraced(input, this.pdaTrace);
+
+        // Read the Int32Array view right away: memory growth detaches it
+        const events = this.pdaTrace.events();
+        const log = [];
+        if (this.pdaTrace.dropped() > 0) {
+            log.push(`Warning: ${this.pdaTrace.dropped()} earlier events not kept`);
+        }
+        for (let i = 0; i < events.length; i += 4) {
+            log.push(this.describePdaEvent(events[i], events[i + 1], events[i + 2]));
+        }
+        return { accepted, log };
+    },
+
+    // Mirrors PDA::describe in PDA.cpp (op codes follow PDATrace::Op)
+    describePdaEvent: function (op, symbol, depth) {
+        const read = `Read '${String.fromCharCode(symbol)}': `;
+        switch (op) {
+            case 0: return "Start: Stack empty";
+            case 1: return `${read}Push 'A' -> Stack size: ${depth}`;
+            case 2: return `${read}Pop 'A' -> Stack size: ${depth}`;
+            case 3: return `${read}Stack empty! REJECT`;
+            case 4: return "End: Input not fully consumed. REJECT";
+            case 5: return "End: Stack not empty. REJECT";
+            case 6: return "End: Stack empty. ACCEPT";
+            default: return `Unknown event ${op}`;
+        }
+    },
+
+    // Same checks and log wording as PDA::checkBalanced / PDA::checkXML, for
+    // WASM builds that predate checkBalancedPDA / checkXMLPDA
+    checkBalancedJS: function (input, isXML) {
+        const MIN_HAIRPIN_LOOP = 3;
+        const stack = [];
+        const log = ["Start: Stack empty"];
+        const reject = (read, error) => {
+            const top = stack.length ? `top '${stack[stack.length - 1].name}'` : "stack empty";
+            log.push(`Read '${read}': No transition (${top}). REJECT`, error);
+            return { accepted: false, log };
+        };
+
+        if (isXML) {
+            // <name ...> pushes, </name> pops, <name .../> leaves the stack alone
+            const tagRegex = /<(\/?)([^>\s\/]+)[^>]*>/g;
+            let match;
+            let foundTags = false;
+            while ((match = tagRegex.exec(input)) !== null) {
+                foundTags = true;
+                const [tag, slash, name] = match;
+                if (tag.endsWith('/>')) {
+                    log.push(`Read '${tag}': No stack change -> Stack size: ${stack.length}`);
+                } else if (!slash) {
+                    stack.push({ name });
+                    log.push(`Read '<${name}>': Push '${name}' -> Stack size: ${stack.length}`);
+                } else if (stack.length === 0) {
+                    return reject(`</${name}>`, "Error: Closing tag with Empty Stack");
+                } else if (stack[stack.length - 1].name !== name) {
+                    const expected = stack[stack.length - 1].name;
+                    return reject(`</${name}>`, `Error: Mismatch, expected </${expected}>`);
+                } else {
+                    stack.pop();
+                    log.push(`Read '</${name}>': Pop '${name}' -> Stack size: ${stack.length}`);
+                }
+            }
+            if (!foundTags) {
+                log.push("End: Stack empty. ACCEPT", "Warning: No valid tags found in XML mode.");
+                return { accepted: true, log };
+            }
+        } else {
+            // '(' pushes its index so the hairpin loop can be measured on ')'
+            for (let i = 0; i < input.length; i++) {
+                const c = input[i];
+                if (c === '(') {
+                    stack.push({ name: '(', index: i });
+                    log.push(`Read '(': Push '(' -> Stack size: ${stack.length}`);
+                } else if (c !== ')') {
+                    log.push(`Read '${c}': No stack change -> Stack size: ${stack.length}`);
+                } else if (stack.length === 0) {
+                    return reject(')', "Error: ')' without matching '(' (Empty Stack)");
+                } else {
+                    const loop = i - stack[stack.length - 1].index - 1;
+                    if (loop < MIN_HAIRPIN_LOOP) {
+                        return reject(')', `Error: Loop size ${loop} < ${MIN_HAIRPIN_LOOP} (Steric Hindrance)`);
+                    }
+                    stack.pop();
+                    log.push(`Read ')': Pop '(' -> Stack size: ${stack.length}`);
+                }
+            }
+        }
+
+        const accepted = stack.length === 0;
+        log.push(accepted ? "End: Stack empty. ACCEPT" : "End: Stack not empty. REJECT");
+        return { accepted, log };
+    },
+
+    escapeHtml: function (text) {
+        return text.replace(/&/g, '&amp;').replace(/</g, '&lt;')
+            .replace(/>/g, '&gt;').replace(/"/g, '&quot;');
+    },
+
+    // PDA log lines are plain text from C++; escape them, then color the operation
+    formatPdaLogLine: function (line) {
+        let html = this.escapeHtml(line);
+        if (/REJECT|Error|Mismatch/.test(line)) {
+            return `<span class="text-red-400">${html}</span>`;
+        }
+        if (/ACCEPT/.test(line)) {
+            return `<span class="text-green-400 font-bold">${html}</span>`;
+        }
+        if (/^Warning/.test(line)) {
+            return `<span class="text-yellow-500 italic">${html}</span>`;
+        }
+        return html
+            .replace(/Push '([^']*)'/g, `<span class="text-green-400">Push '$1'</span>`)
+            .replace(/Pop '([^']*)'/g, `<span class="text-yellow-400">Pop '$1'</span>`);
+    },
+
     reset: function () {
         this.regex = '';
         this.testString = '';
@@ -698,11 +864,25 @@ const AppState = {
         const container = document.getElementById('automata-svg');
 
         let dotString = "";
+        // Bounded writer: merged range labels and a state budget keep Viz.js
+        // responsive on large automata. Node ids already carry the q prefix.
+        const bounded = typeof this.wasmModule.generateDOTBounded_DFA === 'function';
+        const dotOptions = {
+            maxStates: this.maxDiagramStates,
+            maxDepth: -1,
+            mergeEdges: true,
+            clusterSCCs: false,
+            nodePrefix: 'q'
+        };
         try {
             if (this.activeDiagram === 'nfa' && this.currentNFA) {
-                dotString = this.wasmModule.generateDOT_NFA(this.currentNFA);
+                dotString = bounded
+                    ? this.wasmModule.generateDOTBounded_NFA(this.currentNFA, dotOptions)
+                    : this.wasmModule.generateDOT_NFA(this.currentNFA);
             } else if (this.activeDiagram === 'dfa' && this.currentDFA) {
-                dotString = this.wasmModule.generateDOT_DFA(this.currentDFA);
+                dotString = bounded
+                    ? this.wasmModule.generateDOTBounded_DFA(this.currentDFA, dotOptions)
+                    : this.wasmModule.generateDOT_DFA(this.currentDFA);
             } else {
                 // Keep the placeholder icon if possible, or just text
                 // But renderDiagram usually clears innerHTML. 
@@ -716,8 +896,8 @@ const AppState = {
 
             if (!dotString) return;
 
-            // format DOT to use q0, q1...
-            dotString = this.formatDotString(dotString);
+            // format DOT to use q0, q1... (range labels like 0-9 must stay intact)
+            if (!bounded) dotString = this.formatDotString(dotString);
 
             const viz = new Viz();
             viz.renderSVGElement(dotString)
@@ -0,0 +1,116 @@
+// Worker side of WasmWorkerPool (worker_pool.js): loads the WASM core once
+// and runs { type: 'run', taskId, op, args } messages one at a time.
+// Runs as a browser Web Worker or as a Node worker_threads worker.
+const isNodeWorker = typeof self === 'undefined';
+
+let port;
+let createModule;
+if (isNodeWorker) {
+    const { parentPort } = require('worker_threads');
+    port = {
+        post: (msg, transfer) => parentPort.postMessage(msg, transfer || []),
+        listen: fn => parentPort.on('message', fn)
+    };
+    createModule = require('./wasm/formal_sim.js');
+} else {
+    importScripts('wasm/formal_sim.js');
+    createModule = createFormalSimModule;
+    port = {
+        post: (msg, transfer) => self.postMessage(msg, transfer || []),
+        listen: fn => { self.onmessage = e => fn(e.data); }
+    };
+}
+
+let inputBuffer = null; // Reused ByteBuffer in this worker's linear memory
+let compiled = null;    // { regex, dfa } of the last compiled pattern
+
+function compileRegex(M, regex) {
+    if (compiled && compiled.regex === regex) return compiled.dfa;
+    if (compiled) compiled.dfa.delete();
+    const nfa = M.RegexEngine.regexToNFA(regex);
+    const dfa = M.RegexEngine.nfaToDFA(nfa);
+    nfa.delete();
+    compiled = { regex, dfa };
+    return dfa;
+}
+
+const ops = {
+    // One slice of WasmWorkerPool.approximateMatch; ends are global offsets
+    approximateEnds(M, { bytes, shared, from, to, minEnd, pattern, maxErrors }) {
+        const view = shared ? new Uint8Array(shared, from, to - from) : bytes;
+        if (!M.ByteBuffer) {
+            // Older builds: string API, match/no match only
+            const text = new TextDecoder().decode(view.slice());
+            return { value: { matched: M.Matcher.approximateMatch(text, pattern, maxErrors), ends: null } };
+        }
+        if (!inputBuffer) inputBuffer = new M.ByteBuffer(view.length);
+        inputBuffer.resize(view.length).set(view);
+        const local = M.Matcher.approximateMatchEndsBuffer(inputBuffer, pattern, maxErrors);
+        let first = 0;
+        while (first < local.length && local[first] + from <= minEnd) first++;
+        const ends = new Int32Array(local.length - first);
+        for (let i = first; i < local.length; i++) ends[i - first] = local[i] + from;
+        return { value: { matched: ends.length > 0, ends }, transfer: [ends.buffer] };
+    },
+
+    // Whole text in one task: a regex match has no length bound to split on
+    approximateRegexEnds(M, { bytes, regex, maxErrors }) {
+        const matcher = new M.ApproximateRegex(regex, maxErrors);
+        try {
+            if (!inputBuffer) inputBuffer = new M.ByteBuffer(bytes.length);
+            inputBuffer.resize(bytes.length).set(bytes);
+            const ends = matcher.matchEndsBuffer(inputBuffer).slice();
+            return { value: { matched: ends.length > 0, ends }, transfer: [ends.buffer] };
+        } finally {
+            matcher.delete();
+        }
+    },
+
+    matchDFA(M, { regex, text }) {
+        return { value: compileRegex(M, regex).simulate(text) };
+    },
+
+    // Builds the automata off-thread; returns sizes and a DOT rendering
+    compile(M, { regex, maxStates }) {
+        const nfa = M.RegexEngine.regexToNFA(regex);
+        const dfa = compileRegex(M, regex);
+        let dot;
+        if (M.generateDOTBounded_DFA) {
+            dot = M.generateDOTBounded_DFA(dfa, {
+                maxStates: maxStates || 0, maxDepth: -1, mergeEdges: true,
+                clusterSCCs: false, nodePrefix: 'q'
+            });
+        } else {
+            dot = M.generateDOT_DFA(dfa);
+        }
+        const value = { dfaStates: dfa.stateCount ? dfa.stateCount() : null, dot };
+        nfa.delete();
+        return { value };
+    },
+
+    // Uses the C++ thread pool on pthreads builds
+    fold(M, { sequence }) {
+        return { value: M.foldRNA(sequence) };
+    }
+};
+
+const modulePromise = createModule().then(M => {
+    // Pthreads builds run on a SharedArrayBuffer-backed memory
+    const threaded = typeof SharedArrayBuffer !== 'undefined' && !!M.HEAP8 &&
+        M.HEAP8.buffer instanceof SharedArrayBuffer;
+    port.post({ type: 'ready', threaded });
+    return M;
+});
+
+port.listen(async msg => {
+    if (msg.type !== 'run') return;
+    try {
+        const M = await modulePromise;
+        const op = ops[msg.op];
+        if (!op) throw new Error('Unknown operation: ' + msg.op);
+        const { value, transfer } = op(M, msg.args);
+        port.post({ type: 'result', taskId: msg.taskId, value }, transfer);
+    } catch (e) {
+        port.post({ type: 'error', taskId: msg.taskId, message: e.message || String(e) });
+    }
+});
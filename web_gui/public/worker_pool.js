@@ -0,0 +1,262 @@
+// Worker pool: runs the WASM core off the main thread.
+// Works with browser Web Workers and with Node's worker_threads, e.g.
+//   const { WasmWorkerPool } = require('./worker_pool.js');
+//   const pool = new WasmWorkerPool({ size: 4 });
+//   const job = pool.approximateMatch(text, 'ACGT', 1, { onProgress: console.log });
+//   const { matched, ends } = await job.promise; // job.cancel() aborts it
+//   pool.terminate();
+(function (root) {
+    const isNode = typeof window === 'undefined' && typeof process !== 'undefined' &&
+        !!(process.versions && process.versions.node);
+
+    // Resolve the worker script next to this file
+    const scriptUrl = !isNode && typeof document !== 'undefined' && document.currentScript
+        ? document.currentScript.src : null;
+
+    function defaultWorkerUrl() {
+        if (isNode) return require('path').join(__dirname, 'wasm_worker.js');
+        return scriptUrl ? new URL('wasm_worker.js', scriptUrl).href : 'wasm_worker.js';
+    }
+
+    function defaultSize() {
+        const cores = isNode ? require('os').cpus().length
+            : (navigator.hardwareConcurrency || 2);
+        return Math.max(1, Math.min(cores, 8));
+    }
+
+    // Shared text needs SharedArrayBuffer, which browsers only expose on
+    // cross-origin isolated pages (COOP/COEP headers)
+    function canShare() {
+        if (typeof SharedArrayBuffer === 'undefined') return false;
+        return isNode || !!root.crossOriginIsolated;
+    }
+
+    // Same small interface over both worker flavours
+    function spawnWorker(url) {
+        if (isNode) {
+            const { Worker } = require('worker_threads');
+            const worker = new Worker(url);
+            return {
+                post: (msg, transfer) => worker.postMessage(msg, transfer || []),
+                onMessage: fn => worker.on('message', fn),
+                onError: fn => worker.on('error', fn),
+                terminate: () => worker.terminate()
+            };
+        }
+        const worker = new Worker(url);
+        return {
+            post: (msg, transfer) => worker.postMessage(msg, transfer || []),
+            onMessage: fn => { worker.onmessage = e => fn(e.data); },
+            onError: fn => { worker.onerror = e => fn(new Error(e.message || 'Worker error')); },
+            terminate: () => worker.terminate()
+        };
+    }
+
+    function cancelledError() {
+        const err = new Error('Job cancelled');
+        err.cancelled = true;
+        return err;
+    }
+
+    class WasmWorkerPool {
+        constructor(options = {}) {
+            this.size = options.size || defaultSize();
+            this.workerUrl = options.workerUrl || defaultWorkerUrl();
+            this.chunkSize = options.chunkSize || (1 << 20); // Bytes per task
+            this.shared = options.shared !== undefined ? options.shared && canShare() : canShare();
+            this.threaded = false; // Set when a worker reports a pthreads build
+            this.closed = false;
+            this.queue = [];
+            this.slots = [];
+            this.nextJobId = 1;
+            this.nextTaskId = 1;
+            for (let i = 0; i < this.size; i++) this.slots.push(this._spawn());
+            this.ready = Promise.all(this.slots.map(slot => slot.ready));
+        }
+
+        _spawn() {
+            const slot = { handle: spawnWorker(this.workerUrl), task: null, ready: null };
+            slot.ready = new Promise((resolve, reject) => {
+                slot.handle.onMessage(msg => {
+                    if (msg.type === 'ready') {
+                        this.threaded = this.threaded || msg.threaded;
+                        resolve();
+                        this._pump();
+                        return;
+                    }
+                    const task = slot.task;
+                    if (!task || task.id !== msg.taskId) return; // Cancelled meanwhile
+                    slot.task = null;
+                    if (msg.type === 'result') this._finishTask(task, msg.value);
+                    else this._failJob(task.job, new Error(msg.message));
+                    this._pump();
+                });
+                // A crashed worker is dropped; with none left, queued jobs fail
+                slot.handle.onError(err => {
+                    reject(err);
+                    this.slots = this.slots.filter(s => s !== slot);
+                    if (slot.task) this._failJob(slot.task.job, err);
+                    slot.task = null;
+                    if (this.slots.length === 0) {
+                        for (const job of new Set(this.queue.map(task => task.job))) {
+                            this._failJob(job, err);
+                        }
+                    }
+                });
+            });
+            slot.ready.catch(() => { }); // Reported through the job instead
+            return slot;
+        }
+
+        // Hands queued tasks to idle workers
+        _pump() {
+            for (const slot of this.slots) {
+                if (this.queue.length === 0) return;
+                if (slot.task) continue;
+                const task = this.queue.shift();
+                slot.task = task;
+                slot.handle.post({ type: 'run', taskId: task.id, op: task.op, args: task.args },
+                    task.transfer);
+            }
+        }
+
+        _finishTask(task, value) {
+            const job = task.job;
+            if (job.done) return;
+            job.results[task.index] = value;
+            job.completed++;
+            if (job.onProgress) job.onProgress(job.completed, job.tasks);
+            if (job.completed === job.tasks) {
+                job.done = true;
+                job.resolve(job.combine(job.results));
+            }
+        }
+
+        _failJob(job, err) {
+            if (job.done) return;
+            job.done = true;
+            this._dropTasks(job);
+            job.reject(err);
+        }
+
+        // Removes a job's queued tasks and restarts workers busy with it
+        _dropTasks(job) {
+            this.queue = this.queue.filter(task => task.job !== job);
+            this.slots = this.slots.map(slot => {
+                if (!slot.task || slot.task.job !== job) return slot;
+                slot.handle.terminate();
+                return this.closed ? slot : this._spawn();
+            });
+        }
+
+        // Splits work into tasks ({ op, args, transfer }) and merges results
+        _submit(tasks, combine, options = {}) {
+            const job = {
+                id: this.nextJobId++, tasks: tasks.length, completed: 0, done: false,
+                results: new Array(tasks.length), combine, onProgress: options.onProgress
+            };
+            const promise = new Promise((resolve, reject) => {
+                job.resolve = resolve;
+                job.reject = reject;
+            });
+            if (tasks.length === 0) {
+                job.done = true;
+                job.resolve(combine([]));
+            }
+            tasks.forEach((task, index) => {
+                this.queue.push({ id: this.nextTaskId++, job, index, ...task });
+            });
+            this._pump();
+            return {
+                id: job.id,
+                promise,
+                cancel: () => this._failJob(job, cancelledError())
+            };
+        }
+
+        /**
+         * Runs one operation of wasm_worker.js (e.g. 'matchDFA', 'compile',
+         * 'fold') on the next free worker.
+         */
+        run(op, args, options = {}) {
+            return this._submit([{ op, args }], results => results[0], options);
+        }
+
+        /**
+         * Approximate matching over a long text, split into chunkSize slices
+         * that overlap by pattern length + k so no occurrence is lost.
+         * Resolves to { matched, ends } with ends an Int32Array of end
+         * offsets (null on builds without the buffer API).
+         */
+        approximateMatch(text, pattern, maxErrors, options = {}) {
+            const bytes = typeof text === 'string' ? new TextEncoder().encode(text) : text;
+            const overlap = new TextEncoder().encode(pattern).length + Math.max(maxErrors, 0);
+            let shared = null;
+            if (this.shared) {
+                shared = new SharedArrayBuffer(bytes.length);
+                new Uint8Array(shared).set(bytes);
+            }
+
+            const tasks = [];
+            const step = Math.max(this.chunkSize, 1);
+            for (let start = 0; start < bytes.length || start === 0; start += step) {
+                const from = Math.max(0, start - overlap);
+                const to = Math.min(bytes.length, start + step);
+                // Ends at or before `start` belong to the previous slice
+                const args = { from, to, minEnd: start === 0 ? -1 : start, pattern, maxErrors };
+                const task = { op: 'approximateEnds', args };
+                if (shared) {
+                    args.shared = shared;
+                } else {
+                    args.bytes = bytes.slice(from, to);
+                    task.transfer = [args.bytes.buffer];
+                }
+                tasks.push(task);
+                if (to >= bytes.length) break;
+            }
+
+            return this._submit(tasks, results => {
+                const matched = results.some(r => r.matched);
+                if (results.some(r => !r.ends)) return { matched, ends: null };
+                const ends = new Int32Array(results.reduce((n, r) => n + r.ends.length, 0));
+                let offset = 0;
+                for (const r of results) {
+                    ends.set(r.ends, offset);
+                    offset += r.ends.length;
+                }
+                return { matched, ends };
+            }, options);
+        }
+
+        /**
+         * Approximate regex matching (k errors) on one worker. Resolves to
+         * { matched, ends } like approximateMatch.
+         */
+        approximateRegexMatch(text, regex, maxErrors, options = {}) {
+            const bytes = typeof text === 'string' ? new TextEncoder().encode(text) : text.slice();
+            const task = {
+                op: 'approximateRegexEnds', args: { bytes, regex, maxErrors },
+                transfer: [bytes.buffer]
+            };
+            return this._submit([task], results => results[0], options);
+        }
+
+        terminate() {
+            this.closed = true;
+            const jobs = new Set(this.queue.map(task => task.job));
+            for (const slot of this.slots) {
+                if (slot.task) jobs.add(slot.task.job);
+                slot.handle.terminate();
+            }
+            this.slots = [];
+            this.queue = [];
+            for (const job of jobs) this._failJob(job, cancelledError());
+        }
+    }
+
+    if (typeof module !== 'undefined' && module.exports) {
+        module.exports = { WasmWorkerPool };
+    } else {
+        root.WasmWorkerPool = WasmWorkerPool;
+    }
+})(typeof globalThis !== 'undefined' ? globalThis : this);
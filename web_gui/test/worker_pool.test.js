@@ -0,0 +1,106 @@
+// Checks WasmWorkerPool on Node's worker_threads against the built module in
+// web_gui/public/wasm. Run from the repo root: node web_gui/test/worker_pool.test.js
+const assert = require('assert');
+const path = require('path');
+const { WasmWorkerPool } = require(path.join(__dirname, '..', 'public', 'worker_pool.js'));
+
+const PATTERN = 'GATTACA';
+const MAX_ERRORS = 1;
+
+function randomDNA(length, seed) {
+    let x = seed;
+    let out = '';
+    for (let i = 0; i < length; i++) {
+        x = (x * 1103515245 + 12345) >>> 0;
+        out += 'ACGT'[x >>> 30];
+    }
+    return out;
+}
+
+// Background without GATTACA, plus the pattern straddling each slice boundary
+function makeText(length, chunkSize) {
+    const text = randomDNA(length, 7).split('').map(c => c === 'T' ? 'C' : c);
+    for (let at = chunkSize - 3; at + PATTERN.length < length; at += chunkSize) {
+        for (let i = 0; i < PATTERN.length; i++) text[at + i] = PATTERN[i];
+    }
+    return text.join('');
+}
+
+async function run(pool, text, options) {
+    return pool.approximateMatch(text, PATTERN, MAX_ERRORS, options).promise;
+}
+
+async function testSplitMatchesSingleWorker(shared) {
+    const chunkSize = 1 << 14;
+    const text = makeText(20 * chunkSize + 123, chunkSize);
+    const single = new WasmWorkerPool({ size: 1, chunkSize: 1 << 30, shared });
+    const split = new WasmWorkerPool({ size: 4, chunkSize, shared });
+    try {
+        let progress = [];
+        const whole = await run(single, text);
+        const merged = await run(split, text, {
+            onProgress: (done, total) => progress.push([done, total])
+        });
+
+        assert.strictEqual(merged.matched, whole.matched);
+        assert.ok(whole.matched, 'text should contain the pattern');
+        if (whole.ends) {
+            assert.deepStrictEqual(Array.from(merged.ends), Array.from(whole.ends));
+        } else {
+            console.log('  (module predates ByteBuffer: ends not compared)');
+        }
+
+        const tasks = progress.length ? progress[0][1] : 0;
+        assert.ok(tasks > 1, 'text should be split into several tasks');
+        assert.deepStrictEqual(progress.map(p => p[0]),
+            Array.from({ length: tasks }, (_, i) => i + 1));
+
+        const none = await run(split, text.replace(/GATTACA/g, 'GCCCCCA'));
+        assert.strictEqual(none.matched, false);
+    } finally {
+        single.terminate();
+        split.terminate();
+    }
+}
+
+async function testCancelRespawns() {
+    const pool = new WasmWorkerPool({ size: 2, chunkSize: 1 << 12 });
+    try {
+        await pool.ready;
+        const before = pool.slots.map(slot => slot.handle);
+        const job = pool.approximateMatch(randomDNA(1 << 22, 3), PATTERN, MAX_ERRORS);
+        job.cancel();
+        await assert.rejects(job.promise, err => err.cancelled === true);
+
+        assert.strictEqual(pool.slots.length, 2);
+        assert.strictEqual(pool.queue.length, 0);
+        assert.ok(pool.slots.every(slot => !before.includes(slot.handle)),
+            'busy workers should be replaced');
+
+        // The respawned workers take new jobs
+        const result = await run(pool, 'xxGATTACAxx');
+        assert.strictEqual(result.matched, true);
+    } finally {
+        pool.terminate();
+    }
+}
+
+(async () => {
+    const tests = [
+        ['split text matches a single-worker run (copied slices)', () => testSplitMatchesSingleWorker(false)],
+        ['split text matches a single-worker run (shared buffer)', () => testSplitMatchesSingleWorker(true)],
+        ['cancel() rejects the job and respawns its workers', testCancelRespawns]
+    ];
+    let failed = 0;
+    for (const [name, test] of tests) {
+        try {
+            await test();
+            console.log('ok   ' + name);
+        } catch (e) {
+            failed++;
+            console.log('FAIL ' + name);
+            console.log(e.stack);
+        }
+    }
+    process.exitCode = failed ? 1 : 0;
+})();